@@ -3,12 +3,19 @@
 
 """
 make_pt.py
-- addr_log.txt를 읽어 4레벨(x86-64, 4KB) 페이지 테이블을 구성하고,
-  메모리맵 형식(uint8, 64B line)으로 <kernel>_pt.data 를 생성합니다.
+- addr_log.txt를 읽어 4레벨(x86-64) 페이지 테이블을 구성하고,
+  메모리맵 형식(uint8, --line_size 라인)으로 <kernel>_pt.data 를 생성합니다.
+- --page_size 2097152 / 1073741824 이면 PDE / PDPTE에 PS 비트를 켜서
+  2MB / 1GB huge page leaf로 매핑합니다.
 
 주요 옵션
 --pt_base   : PML4 물리 베이스(CR3). 예) 0x900000000000 또는 0x0009000000000000
 --addr_shift: addr_log가 VPN(VA>>shift)이면 그 shift (기본 12), 바이트 주소면 0
+--page_size : leaf 페이지 크기 (4096, 2097152, 1073741824)
+--line_size : memory map 라인 크기 = 빌드의 PACKET_SIZE(MEM_ACCESS_SIZE, 기본 32)
+
+큰 입력에는 C++ 버전(build/bin/make_pt)을 쓰거나, config에서
+build_page_table=1로 시뮬레이터가 시작할 때 직접 테이블을 만들게 하세요.
 """
 
 import argparse
@@ -16,11 +23,14 @@ import os
 import re
 
 PAGE_SIZE       = 4096
+HUGE_2M         = 2 * 1024 * 1024
+HUGE_1G         = 1024 * 1024 * 1024
 ENTRIES_PER_PT  = 512
 ENTRY_SIZE      = 8
-LINE_SIZE       = 64  # 64B 라인
+LINE_SIZE       = 32  # 기본 라인 크기 (기본 빌드의 PACKET_SIZE)
 
 PTE_FLAGS = 0x3       # Present | RW
+PTE_PS    = 0x80      # PDE/PDPTE leaf (huge page)
 
 ADDR_RE = re.compile(r'0x([0-9a-fA-F]+)')
 
@@ -45,15 +55,16 @@ def kernel_to_basename(kname: str) -> str:
 def align_down(x: int, a: int) -> int:
     return x & ~(a - 1)
 
-def line_base(addr: int) -> int:
-    return addr & ~(LINE_SIZE - 1)
+def line_base(addr: int, line_size: int) -> int:
+    return addr & ~(line_size - 1)
 
-def write_qword(mem_lines: dict, page_addr: int, index: int, value: int):
+def write_qword(mem_lines: dict, page_addr: int, index: int, value: int,
+                line_size: int = LINE_SIZE):
     """page_addr 페이지의 index 번째 엔트리에 8B little-endian으로 value 기록."""
     offset = index * ENTRY_SIZE
-    lb = line_base(page_addr + offset)
+    lb = line_base(page_addr + offset, line_size)
     pos = (page_addr + offset) - lb
-    buf = mem_lines.setdefault(lb, bytearray(LINE_SIZE))
+    buf = mem_lines.setdefault(lb, bytearray(line_size))
     for i in range(8):
         buf[pos + i] = (value >> (8 * i)) & 0xFF
 
@@ -81,12 +92,19 @@ def read_unique_pages(addr_log_path: str, page_size: int, addr_shift: int):
             total += 1
     return unique_pages, total
 
-def build_pt(unique_pages, pt_base):
+def build_pt(unique_pages, pt_base, page_size=PAGE_SIZE, line_size=LINE_SIZE):
     """
-    unique_pages: VA 페이지들의 집합 (또는 복원된 VA)
-    반환: mem_lines(dict: line_addr -> 64B bytes)
+    unique_pages: VA 페이지들의 집합 (또는 복원된 VA), page_size 정렬
+    page_size   : leaf 크기. 2MB면 PDE, 1GB면 PDPTE에서 leaf로 끝냄
+    line_size   : 라인 크기 (시뮬레이터 빌드의 PACKET_SIZE와 같아야 함)
+    반환: mem_lines(dict: line_addr -> line_size bytes)
     """
-    mem_lines = {}  # 64B line 단위 기록
+    if page_size not in (PAGE_SIZE, HUGE_2M, HUGE_1G):
+        raise ValueError(f"unsupported page size {page_size}")
+    if line_size < ENTRY_SIZE or line_size & (line_size - 1):
+        raise ValueError(f"unsupported line size {line_size}")
+
+    mem_lines = {}  # line_size 라인 단위 기록
 
     # 테이블 페이지 할당 상태
     next_free = pt_base + PAGE_SIZE  # PML4 다음 페이지부터
@@ -105,7 +123,12 @@ def build_pt(unique_pages, pt_base):
             pdpt_phys = next_free
             next_free += PAGE_SIZE
             pdpt_pages[pml4_i] = pdpt_phys
-            write_qword(mem_lines, pml4_page, pml4_i, pdpt_phys | PTE_FLAGS)
+            write_qword(mem_lines, pml4_page, pml4_i, pdpt_phys | PTE_FLAGS, line_size)
+
+        # 1GB leaf: PDPTE에서 종료 (아이덴티티 매핑)
+        if page_size == HUGE_1G:
+            write_qword(mem_lines, pdpt_pages[pml4_i], pdpt_i, va_page | PTE_FLAGS | PTE_PS, line_size)
+            continue
 
         # 2) PDPT -> PD
         key2 = (pml4_i, pdpt_i)
@@ -113,7 +136,12 @@ def build_pt(unique_pages, pt_base):
             pd_phys = next_free
             next_free += PAGE_SIZE
             pd_pages[key2] = pd_phys
-            write_qword(mem_lines, pdpt_pages[pml4_i], pdpt_i, pd_phys | PTE_FLAGS)
+            write_qword(mem_lines, pdpt_pages[pml4_i], pdpt_i, pd_phys | PTE_FLAGS, line_size)
+
+        # 2MB leaf: PDE에서 종료 (아이덴티티 매핑)
+        if page_size == HUGE_2M:
+            write_qword(mem_lines, pd_pages[key2], pd_i, va_page | PTE_FLAGS | PTE_PS, line_size)
+            continue
 
         # 3) PD -> PT
         key3 = (pml4_i, pdpt_i, pd_i)
@@ -121,10 +149,10 @@ def build_pt(unique_pages, pt_base):
             _pt_phys = next_free
             next_free += PAGE_SIZE
             pt_pages[key3] = _pt_phys
-            write_qword(mem_lines, pd_pages[key2], pd_i, _pt_phys | PTE_FLAGS)
+            write_qword(mem_lines, pd_pages[key2], pd_i, _pt_phys | PTE_FLAGS, line_size)
 
         # 4) PT leaf: (임시) VA와 동일한 프레임으로 아이덴티티 매핑
-        write_qword(mem_lines, pt_pages[key3], pt_i, va_page | PTE_FLAGS)
+        write_qword(mem_lines, pt_pages[key3], pt_i, va_page | PTE_FLAGS, line_size)
 
     return mem_lines
 
@@ -132,9 +160,9 @@ def dump_memmap_uint8(mem_lines: dict, out_path: str):
     with open(out_path, 'w') as f:
         f.write("_META_\nuint8\n_DATA_\n")
         for addr in sorted(mem_lines.keys()):
-            bytes64 = mem_lines[addr]
+            line_bytes = mem_lines[addr]
             # 주소 16자리 0패딩
-            f.write(f"0x{addr:016x} " + " ".join(str(b) for b in bytes64) + "\n")
+            f.write(f"0x{addr:016x} " + " ".join(str(b) for b in line_bytes) + "\n")
 
 def parse_int_auto(s: str) -> int:
     """'0x...' 또는 10진 모두 허용"""
@@ -149,7 +177,10 @@ def main():
                     help='addr_log가 VPN(VA>>shift)라면 그 shift 값 (기본 12). 바이트 주소면 0.')
     ap.add_argument('--pt_base', type=parse_int_auto, default=parse_int_auto("0x0009000000000000"),
                     help='PML4 물리 베이스(CR3). 예) 0x900000000000 또는 0x0009000000000000')
-    ap.add_argument('--page_size', type=int, default=PAGE_SIZE)
+    ap.add_argument('--page_size', type=int, default=PAGE_SIZE,
+                    help='leaf 페이지 크기: 4096, 2097152(2MB), 1073741824(1GB)')
+    ap.add_argument('--line_size', type=int, default=LINE_SIZE,
+                    help='memory map 라인 크기. 시뮬레이터의 PACKET_SIZE(MEM_ACCESS_SIZE)와 같아야 함 (기본 32)')
     args = ap.parse_args()
 
     addr_log = os.path.join(args.input_dir, "addr_log.txt")
@@ -162,16 +193,16 @@ def main():
     out_path = os.path.join(args.output_dir, out_name)
 
     unique_pages, total_accesses = read_unique_pages(addr_log, args.page_size, args.addr_shift)
-    mem_lines = build_pt(unique_pages, args.pt_base)
+    mem_lines = build_pt(unique_pages, args.pt_base, args.page_size, args.line_size)
 
     # 통계
     lines_emitted   = len(mem_lines)
-    pt_pages_alloc  = len({align_down(a, args.page_size) for a in mem_lines.keys()})
+    pt_pages_alloc  = len({align_down(a, PAGE_SIZE) for a in mem_lines.keys()})
 
-    print(f"[{base}] total accesses={total_accesses}, unique 4KB pages={len(unique_pages)}")
+    print(f"[{base}] total accesses={total_accesses}, unique {args.page_size}B pages={len(unique_pages)}")
     print(f"  PML4 base = 0x{args.pt_base:016x}")
     print(f"  allocated PT pages = {pt_pages_alloc}")
-    print(f"  emitted 64B lines  = {lines_emitted}")
+    print(f"  emitted {args.line_size}B lines  = {lines_emitted}")
 
     dump_memmap_uint8(mem_lines, out_path)
     print(f"  -> wrote {out_path}")
@@ -44,6 +44,8 @@ parser.add_argument('--skip_functional_sim', action='store_true', help='skip fun
 parser.add_argument('--config', type=str, default='m2ndp.config', help='config file')
 parser.add_argument('--num_m2ndps', type=int, default=1, help='number of m2ndps')
 parser.add_argument('--arg', type=float, default=-1, help='arg for kernel')
+parser.add_argument('--binary_image', action='store_true', default=False,
+                    help='also convert memory maps to binary images (build/bin/make_mimg)')
 
 if __name__ == "__main__":
     args = parser.parse_args()
@@ -76,6 +78,9 @@ if __name__ == "__main__":
         for i in range(args.num_m2ndps):
             make_input_files(kernel.kernel_name, kernel_code, input_map[i], 
                             output_map[i], kernel_info[i], file_dir=os.path.join(args.output_dir, str(i)))
+    if args.binary_image:
+        for i in range(args.num_m2ndps):
+            make_memory_images(kernel.kernel_name, file_dir=os.path.join(args.output_dir, str(i)))
     if not args.skip_functional_sim:
         for i in range(args.num_m2ndps):
             execute_functional_sim(kernel.kernel_name, config=args.config, 
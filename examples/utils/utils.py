@@ -192,14 +192,33 @@ def make_input_files_multi_ndp(kernel_name, kernel_string, input_memory_map, out
         file.close()
 
 
+def memory_map_path(prefix):
+    # binary memory image(make_mimg로 변환)가 .data보다 새로우면 그것을 사용
+    image, text = f'{prefix}.mimg', f'{prefix}.data'
+    if os.path.isfile(image) and (not os.path.isfile(text) or
+                                  os.path.getmtime(image) >= os.path.getmtime(text)):
+        return image
+    return text
+
+def make_memory_images(kernel_name, file_dir='./', extra_inputs=()):
+    # <kernel>_input.data(+ _pt.data 등)와 _output.data를 .mimg로 변환
+    this_file_dir = os.path.dirname(os.path.abspath(__file__))
+    exec_file = os.path.join(this_file_dir, '../../build/bin/make_mimg')
+    inputs = [f'{file_dir}/{kernel_name}_input.data'] + list(extra_inputs)
+    for name, srcs in (('input', inputs), ('output', [f'{file_dir}/{kernel_name}_output.data'])):
+        script = f'{exec_file} --output {file_dir}/{kernel_name}_{name}.mimg' \
+                 + ''.join(f' --input {src}' for src in srcs)
+        print(script)
+        os.system(script)
+
 def execute_functional_sim(kernel_name, config='m2ndp.config', file_dir='./'):
     os.system("echo \"Running FuncSim..\"")
     this_file_dir = os.path.dirname(os.path.abspath(__file__))
     exec_file = os.path.join(this_file_dir, '../../build/bin/FuncSim')
     config_dir = os.path.join(this_file_dir, '../../config/functional_only')
     script = f'{exec_file} --ndp_trace {file_dir}/{kernel_name}.traceg' \
-                            + f' --memory_map  {file_dir}/{kernel_name}_input.data' \
-                            + f' --target_map  {file_dir}/{kernel_name}_output.data' \
+                            + f' --memory_map  {memory_map_path(f"{file_dir}/{kernel_name}_input")}' \
+                            + f' --target_map  {memory_map_path(f"{file_dir}/{kernel_name}_output")}' \
                             + f' --launch_file {file_dir}/{kernel_name}_launch.txt ' \
                             + f' --config {config_dir}/{config}'
     print(script)
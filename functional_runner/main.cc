@@ -6,6 +6,7 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/cfg/env.h>
 #include <fstream>
+#include <memory>
 
 namespace po = boost::program_options;
 using namespace NDPSim;
@@ -28,6 +29,8 @@ void functional_simulation(int argc, char** argv) {
   cmd_parser.add_command_line_option<std::string>("config",
                                                   "path for config file");
   cmd_parser.add_command_line_option<int>("option", "trace option");
+  cmd_parser.add_command_line_option<int>(
+      "match_report_limit", "mismatched lines to print on check failure");
   try {
     cmd_parser.parse(argc, argv);
   } catch (const CommandLineParser::ParsingError& e) {
@@ -42,6 +45,7 @@ void functional_simulation(int argc, char** argv) {
   std::string config_path;
   std::string launch_file_path;
   TraceOption trace_option = SINGLE;
+  int match_report_limit = 16;
 
   cmd_parser.set_if_defined("ndp_trace", &ndp_file_path);
   cmd_parser.set_if_defined("memory_map", &memory_map_path);
@@ -49,8 +53,11 @@ void functional_simulation(int argc, char** argv) {
   cmd_parser.set_if_defined("launch_file", &launch_file_path);
   cmd_parser.set_if_defined("config", &config_path);
   cmd_parser.set_if_defined("option", (int*)&trace_option);
+  cmd_parser.set_if_defined("match_report_limit", &match_report_limit);
 
-  HashMemoryMap memory_map(memory_map_path);
+  // binary memory image(.mimg)면 FlatMemoryMap으로 매핑
+  std::unique_ptr<MemoryMap> memory_map(MemoryMap::New(
+      "hash", memory_map_path, FlatMemoryMap::DEFAULT_PAGE_SIZE));
 
   if (trace_option == SINGLE) {
     // Initialize NDP fuctions, Memory map, NDP units
@@ -65,11 +72,11 @@ void functional_simulation(int argc, char** argv) {
     int num_ndp = config->get_num_ndp_units();
     M2NDPParser::parse_ndp_kernel(num_ndp, ndp_file_path, &ndp_kernel, config);
     if (config->get_use_synthetic_memory())
-        memory_map.set_synthetic_memory(config->get_synthetic_base_address(),
+        memory_map->set_synthetic_memory(config->get_synthetic_base_address(),
                                         config->get_synthetic_memory_size());
     ndp_units.resize(num_ndp);
     for (int id = 0; id < num_ndp; id++) {
-      ndp_units[id] = new NdpUnit(config, &memory_map, id);
+      ndp_units[id] = new NdpUnit(config, memory_map.get(), id);
     }
 
     // // Run Functional simulation on NDP unit
@@ -96,7 +103,7 @@ void functional_simulation(int argc, char** argv) {
 
     ndp_units.resize(num_ndp);
     for (int id = 0; id < num_ndp; id++) {
-      ndp_units[id] = new NdpUnit(config, &memory_map, id);
+      ndp_units[id] = new NdpUnit(config, memory_map.get(), id);
     }
 
     for (int loop = 0; loop < num_loop; loop++) {
@@ -109,9 +116,11 @@ void functional_simulation(int argc, char** argv) {
       }  
     }
   } 
-  HashMemoryMap target_map(target_map_path);
+  std::unique_ptr<MemoryMap> target_map(MemoryMap::New(
+      "hash", target_map_path, FlatMemoryMap::DEFAULT_PAGE_SIZE));
+  target_map->set_match_report_limit(match_report_limit);
   // Check memory value
-  if (target_map.Match(memory_map)) {
+  if (target_map->Match(*memory_map)) {
     spdlog::info("Functional simulation success");
     printf(" _____                             \n");
     printf("/  ___|                             _ _ \n");
@@ -220,7 +220,9 @@ void KVRunner::parse_ndp_trace() {
   spdlog::debug("Parsing trace...");
   // make input memory map at first kernel
   std::string input_memory_path = m_trace_dir_path + "/input.data";
-  m_memory_map = new HashMemoryMap(input_memory_path);
+  m_memory_map = MemoryMap::New(m_m2ndp_config->get_memory_map_backend(),
+                                input_memory_path,
+                                m_m2ndp_config->get_memory_map_page_size());
   std::ifstream ifs_data(m_trace_dir_path + "/launch.txt");
   assert(ifs_data.is_open());
   std::string line;
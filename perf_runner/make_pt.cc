@@ -0,0 +1,143 @@
+// make_pt: examples/make_pt.py의 C++ 버전.
+// addr_log.txt(또는 --range)로 4-레벨 페이지 테이블을 만들어
+// memory map 텍스트 형식(uint8, PACKET_SIZE 라인)의 _pt.data로 저장한다.
+#include <spdlog/spdlog.h>
+#include <spdlog/cfg/env.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "command_line_parser.h"
+#include "page_table_builder.h"
+
+using namespace NDPSim;
+
+static uint64_t parse_int_auto(const std::string& s) {
+  return std::stoull(s, nullptr, 0);
+}
+
+// 각 줄의 첫 "0x..." 값을 주소로 (addr_shift만큼 올림)
+static uint64_t read_addr_log(const std::string& path, int addr_shift,
+                              PageTableBuilder& builder) {
+  std::ifstream ifs(path);
+  if (!ifs.good()) {
+    spdlog::error("addr_log not found: {}", path);
+    exit(1);
+  }
+  uint64_t total = 0;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    size_t pos = line.find("0x");
+    if (pos == std::string::npos) continue;
+    uint64_t addr = strtoull(line.c_str() + pos, nullptr, 16);
+    builder.add_page(addr << addr_shift);
+    total++;
+  }
+  return total;
+}
+
+int main(int argc, char* argv[]) {
+  spdlog::cfg::load_env_levels();
+  CommandLineParser cmd_parser = CommandLineParser();
+  cmd_parser.add_command_line_option<std::string>(
+      "addr_log", "address log (first hex value of each line)");
+  cmd_parser.add_command_line_multitoken_option<std::vector<std::string>>(
+      "range", "VA range base:size to map (can be repeated)");
+  cmd_parser.add_command_line_option<std::string>("output",
+                                                  "output _pt.data path");
+  cmd_parser.add_command_line_option<int>(
+      "addr_shift", "shift if addr_log holds VPNs (default 12, 0 for bytes)");
+  cmd_parser.add_command_line_option<std::string>(
+      "pt_base", "PML4 physical base (default 0x0009000000000000)");
+  cmd_parser.add_command_line_option<uint64_t>(
+      "page_size", "leaf page size: 4096, 2097152, 1073741824");
+  cmd_parser.add_command_line_option<std::string>(
+      "policy", "identity, random or coloring");
+  cmd_parser.add_command_line_option<std::string>(
+      "frame_base", "first physical frame for random/coloring");
+  cmd_parser.add_command_line_option<int>("colors", "number of page colors");
+  cmd_parser.add_command_line_option<uint64_t>("seed", "random seed");
+  cmd_parser.add_command_line_option<std::string>(
+      "stage2_output", "also write a stage-2 table for nested_paging");
+  cmd_parser.add_command_line_option<std::string>(
+      "stage2_pt_base", "stage-2 root (default 0x000A000000000000)");
+  try {
+    cmd_parser.parse(argc, argv);
+  } catch (const CommandLineParser::ParsingError& e) {
+    spdlog::error("Command line argument parsing error: {}", e.what());
+    return 1;
+  }
+  cmd_parser.print_help_message_if_required();
+
+  std::string addr_log, output, policy = "identity";
+  std::string pt_base = "0x0009000000000000", frame_base = "0";
+  std::string stage2_output, stage2_pt_base = "0x000A000000000000";
+  std::vector<std::string> ranges;
+  int addr_shift = 12;
+  uint64_t page_size = 4096;
+  PageTableBuildConfig config;
+  cmd_parser.set_if_defined("addr_log", &addr_log);
+  cmd_parser.set_if_defined("range", &ranges);
+  cmd_parser.set_if_defined("output", &output);
+  cmd_parser.set_if_defined("addr_shift", &addr_shift);
+  cmd_parser.set_if_defined("pt_base", &pt_base);
+  cmd_parser.set_if_defined("page_size", &page_size);
+  cmd_parser.set_if_defined("policy", &policy);
+  cmd_parser.set_if_defined("frame_base", &frame_base);
+  cmd_parser.set_if_defined("colors", &config.num_colors);
+  cmd_parser.set_if_defined("seed", &config.seed);
+  cmd_parser.set_if_defined("stage2_output", &stage2_output);
+  cmd_parser.set_if_defined("stage2_pt_base", &stage2_pt_base);
+  if (output.empty() || (addr_log.empty() && ranges.empty())) {
+    spdlog::error("--output and one of --addr_log / --range are required");
+    return 1;
+  }
+  config.policy = PageTableBuildConfig::parse_policy(policy);
+  config.page_shift = PageTableBuildConfig::parse_page_shift(page_size);
+  config.pt_base = parse_int_auto(pt_base);
+  config.frame_base = parse_int_auto(frame_base);
+
+  auto start = std::chrono::steady_clock::now();
+  PageTableBuilder builder(config);
+  uint64_t accesses = 0;
+  if (!addr_log.empty())
+    accesses = read_addr_log(addr_log, addr_shift, builder);
+  for (const std::string& range : ranges) {
+    size_t colon = range.find(':');
+    if (colon == std::string::npos) {
+      spdlog::error("range must be base:size ({})", range);
+      return 1;
+    }
+    builder.add_range(parse_int_auto(range.substr(0, colon)),
+                      parse_int_auto(range.substr(colon + 1)));
+  }
+  builder.build();
+  builder.write_memmap(output);
+  uint64_t stage2_tables = 0;
+  if (!stage2_output.empty()) {
+    // guest 테이블과 guest 프레임을 gPA == hPA로 매핑
+    PageTableBuildConfig s2_config;
+    s2_config.pt_base = parse_int_auto(stage2_pt_base);
+    PageTableBuilder s2_builder(s2_config);
+    s2_builder.add_guest_physical(builder);
+    s2_builder.build();
+    s2_builder.write_memmap(stage2_output);
+    stage2_tables = s2_builder.get_num_tables();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  spdlog::info("total accesses={}, unique {}B pages={}", accesses, page_size,
+               builder.get_num_pages());
+  spdlog::info("  PML4 base = {:#018x}, policy = {}", config.pt_base, policy);
+  spdlog::info("  allocated PT pages = {}", builder.get_num_tables());
+  spdlog::info("  emitted {}B lines  = {}", PACKET_SIZE, builder.get_num_lines());
+  if (!stage2_output.empty())
+    spdlog::info("  stage-2 PT pages   = {} -> {}", stage2_tables, stage2_output);
+  spdlog::info("  -> wrote {} in {} ms", output,
+               std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                   .count());
+  return 0;
+}
@@ -226,7 +226,11 @@ void ScalabilityRunner::parse_ndp_trace(int buffer_id) {
       //make input memory map at first kernel
       std::string input_memory_path =
           trace_dir_path + "/" + file_name + "_input.data";
-      m_memory_map[buffer_id] = new HashMemoryMap(input_memory_path);
+      m_memory_map[buffer_id] = MemoryMap::New(
+          m_m2ndp_config->get_memory_map_backend(), input_memory_path,
+          m_m2ndp_config->get_memory_map_page_size());
+      m_memory_map[buffer_id]->set_match_report_limit(
+          m_m2ndp_config->get_match_report_limit());
       if (m_m2ndp_config->get_use_synthetic_memory())
         m_memory_map[buffer_id]->set_synthetic_memory(
             m_m2ndp_config->get_synthetic_base_address(),
@@ -236,7 +240,9 @@ void ScalabilityRunner::parse_ndp_trace(int buffer_id) {
       //make target memory map at last kernel
       std::string target_memory_path =
           trace_dir_path + "/" + file_name + "_output.data";
-      m_target_map[buffer_id] = new HashMemoryMap(target_memory_path);
+      m_target_map[buffer_id] = MemoryMap::New(
+          m_m2ndp_config->get_memory_map_backend(), target_memory_path,
+          m_m2ndp_config->get_memory_map_page_size());
     }
     NdpCommand command = NdpCommand{
         .ndp_kernel_path = trace_dir_path + "/" + kernel_name + ".traceg",
@@ -1,14 +1,18 @@
 #include "simulation_runner.h"
 
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "command_line_parser.h"
+#include "page_table_builder.h"
 namespace po = boost::program_options;
 namespace NDPSim {
 SimulationRunner::SimulationRunner(int argc, char* argv[])
-    : remaing_memory_reqs(0), m_memory_map(NULL), m_target_map(NULL) {
+    : remaing_memory_reqs(0), m_memory_map(NULL), m_target_map(NULL),
+      m_iommu(NULL) {
   CommandLineParser cmd_parser = CommandLineParser();
   cmd_parser.add_command_line_option<std::string>("config",
                                                   "path for m2ndp config file");
@@ -56,12 +60,23 @@ SimulationRunner::SimulationRunner(int argc, char* argv[])
   m_m2ndp_config->set_output_file(m_output_file);
   m_m2ndp_config->print_config(m_output_file);
   parse_ndp_trace();
+  if (m_m2ndp_config->is_build_page_table())
+    build_page_table();
+  else if (m_m2ndp_config->get_page_table_placement() != "contiguous")
+    spdlog::warn("page_table_placement {} needs build_page_table=1, ignored",
+                 m_m2ndp_config->get_page_table_placement());
+  if (m_m2ndp_config->is_memory_map_restore() && m_memory_map)
+    m_baseline_map = m_memory_map->Snapshot();
+  load_tlb_inval_trace();
+  m_iommu = new Iommu(m_m2ndp_config, m_memory_map);
   for (int i = 0; i < m_num_m2ndps; i++) {
     m_m2ndps[i] = new M2NDP(m_m2ndp_config, m_memory_map, i);
     m_m2ndps[i]->set_cxl_link(m_cxl_link);
   }
 }
 
+SimulationRunner::~SimulationRunner() { delete m_baseline_map; }
+
 void SimulationRunner::run() {
   extern Stats_NDPSim::StatList statlist;
 
@@ -80,6 +95,14 @@ void SimulationRunner::run() {
       m_bi_reqs.pop();
       m_memory_reqs[0].push(mf);
     }
+    if (!m_host_translation_reqs.empty() &&
+        m_host_translation_reqs.begin()->first <=
+            m_m2ndp_config->get_ndp_cycle()) {
+      mem_fetch* mf = m_host_translation_reqs.begin()->second;
+      m_host_translation_reqs.erase(m_host_translation_reqs.begin());
+      if (mf->is_page_fault()) handle_page_fault(mf);
+      m_memory_reqs[0].push(mf);
+    }
     if (check_single_simulation_finished()) {
       if (!m_ndp_commands.empty()) {
         NdpCommand command = m_ndp_commands.front();
@@ -96,11 +119,20 @@ void SimulationRunner::run() {
         }
       }
     }
+    issue_tlb_invalidations();
     process_memory_access();
   }
   fprintf(m_output_file, "========== CXL LINK STATS ==========\n");
   m_cxl_link->display_stats(m_output_file);
   m_cxl_link->print_energy_stats(m_energy_file, "LINK");
+  fprintf(m_output_file, "========== HOST IOMMU STATS ==========\n");
+  m_iommu->print_stats(m_output_file);
+  if (m_shootdowns_issued) {
+    fprintf(m_output_file, "========== TLB SHOOTDOWN STATS ==========\n");
+    fprintf(m_output_file, "tlb_shootdowns: %lu (invalidated entries %lu)\n",
+            m_shootdowns_issued, m_shootdown_entries);
+    m_shootdown_latency.print_stats(m_output_file, "tlb shootdown latency");
+  }
   fprintf(m_output_file, "========== CXL MEMORY BUFFER STATS  ==========\n");
   for (auto m2ndp : m_m2ndps) {
     m2ndp->display_stats(m_output_file);
@@ -116,7 +148,8 @@ void SimulationRunner::run() {
 
 bool SimulationRunner::check_all_simulaiton_finished() {
   bool running = remaing_memory_reqs > 0 || !check_all_memory_reqs_empty() ||
-                 !m_ndp_commands.empty();
+                 !m_ndp_commands.empty() || !m_host_translation_reqs.empty() ||
+                 !m_inflight_shootdowns.empty();
 
   running = running || m_cxl_link->is_active();
   for (int i = 0; i < m_num_m2ndps; i++) {
@@ -146,6 +179,14 @@ bool SimulationRunner::check_can_launch_ndp_kernel() {
 void SimulationRunner::launch_ndp_kernel(NdpCommand command) {
   spdlog::info("Launching NDP kernel: {} at cycle {}", command.ndp_kernel_path,
                m_m2ndp_config->get_sim_cycle());
+  // 이전 커널이 모두 끝난 뒤에만 launch하므로 바로 되돌려도 됨
+  if (m_baseline_map && m_num_launched_kernels > 0) {
+    m_memory_map->Restore(*m_baseline_map);
+    // page table 라인도 baseline으로 돌아가므로 캐시된 변환을 모두 버림
+    m_iommu->flush();
+    for (auto m2ndp : m_m2ndps) m2ndp->flush_tlbs();
+  }
+  m_num_launched_kernels++;
   for (auto m2ndp : m_m2ndps) {
     m2ndp->register_ndp_kernel(0, command.ndp_kernel_path);
   }
@@ -185,13 +226,18 @@ void SimulationRunner::process_memory_access() {
         if (m_cxl_link->has_buffer_from_host(host, node_id, mf)) {
           m_cxl_link->push_from_host(host, node_id, mf);
           m_memory_reqs[host].pop();
-          if(!mf->is_bi() && !mf->is_bi_writeback() && !mf->is_uthread_request())
+          if(!mf->is_bi() && !mf->is_bi_writeback() && !mf->is_uthread_request() &&
+             !mf->is_host_translation() && !mf->is_tlb_invalidate())
             remaing_memory_reqs++;
         }
       }
       if (m_cxl_link->top_from_host(host, node_id) != NULL) {
         mem_fetch* mf = m_cxl_link->top_from_host(host, node_id);
-        if(!mf->is_request()) {
+        if (mf->is_tlb_invalidate()) {
+          m_cxl_link->pop_from_host(host, node_id);
+          handle_shootdown_ack(mf);
+        }
+        else if(!mf->is_request()) {
           assert(!mf->get_from_ndp() && !mf->get_from_dma());
           m_cxl_link->pop_from_host(host, node_id);
           remaing_memory_reqs--;
@@ -201,6 +247,23 @@ void SimulationRunner::process_memory_access() {
           }
           delete mf;
         }
+        else if (mf->is_page_fault()) {
+          mf->current_state = "page fault handled";
+          mf->set_reply();
+          m_host_translation_reqs.insert(std::make_pair(
+              m_m2ndp_config->get_ndp_cycle() +
+                  m_m2ndp_config->get_page_fault_latency(),
+              mf));
+          m_cxl_link->pop_from_host(host, node_id);
+        }
+        else if (mf->is_ats_request()) {
+          mf->current_state = "ATS handled";
+          mf->set_reply();
+          uint64_t ready = m_iommu->translate((AtsInfo*)mf->get_data(),
+                                              m_m2ndp_config->get_ndp_cycle());
+          m_host_translation_reqs.insert(std::make_pair(ready, mf));
+          m_cxl_link->pop_from_host(host, node_id);
+        }
         else {
           mf->current_state = "BI handled";
           mf->set_reply();
@@ -219,6 +282,107 @@ void SimulationRunner::process_memory_access() {
   }
 }
 
+void SimulationRunner::handle_page_fault(mem_fetch* mf) {
+  // 폴트 처리는 IOMMU로 넘김
+  PageFaultInfo* info = (PageFaultInfo*)mf->get_data();
+  m_iommu->handle_page_fault(info->va, info->pt_base);
+}
+
+void SimulationRunner::load_tlb_inval_trace() {
+  std::string path = m_m2ndp_config->get_tlb_inval_trace();
+  if (path.empty()) return;
+  std::ifstream ifs(path);
+  if (!ifs.good()) ifs.open(m_trace_dir_path + "/" + path);
+  if (!ifs.good()) {
+    spdlog::error("TLB invalidation trace not found: {}", path);
+    exit(1);
+  }
+  // "<ndp cycle> <va> [pages] [asid]" (va는 hex 가능, asid 생략 시 전체)
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::stringstream ss(line);
+    std::string cycle, va, pages = "1", asid = "-1";
+    if (!(ss >> cycle >> va)) continue;
+    ss >> pages >> asid;
+    m_tlb_inval_events.push_back(TlbInvalEvent{
+        std::stoull(cycle, nullptr, 0), std::stoull(va, nullptr, 0),
+        std::stoull(pages, nullptr, 0), std::stoi(asid, nullptr, 0)});
+  }
+  std::stable_sort(m_tlb_inval_events.begin(), m_tlb_inval_events.end(),
+                   [](const TlbInvalEvent& a, const TlbInvalEvent& b) {
+                     return a.cycle < b.cycle;
+                   });
+  spdlog::info("Loaded {} TLB invalidations from {}",
+               m_tlb_inval_events.size(), path);
+}
+
+void SimulationRunner::issue_tlb_invalidations() {
+  uint64_t now = m_m2ndp_config->get_ndp_cycle();
+  while (!m_tlb_inval_events.empty() &&
+         m_tlb_inval_events.front().cycle <= now) {
+    TlbInvalEvent& e = m_tlb_inval_events.front();
+    send_tlb_invalidation(e.va, e.num_pages, e.asid);
+    m_tlb_inval_events.pop_front();
+  }
+  // trace가 없으면 커널이 도는 동안 interval마다 launch 범위의 임의 페이지
+  int interval = m_m2ndp_config->get_tlb_inval_interval();
+  if (interval <= 0 || !m_m2ndp_config->get_tlb_inval_trace().empty() ||
+      m_launch_ranges.empty() || now < m_next_tlb_inval_cycle ||
+      !check_ndp_kenrel_active())
+    return;
+  m_next_tlb_inval_cycle = now + interval;
+  auto& range = m_launch_ranges[rand() % m_launch_ranges.size()];
+  uint64_t pages = std::max<uint64_t>(range.second >> 12, 1);
+  uint64_t va = (range.first & ~0xFFFULL) + ((uint64_t)rand() % pages << 12);
+  send_tlb_invalidation(va, m_m2ndp_config->get_tlb_inval_pages(), -1);
+}
+
+void SimulationRunner::send_tlb_invalidation(uint64_t va, uint64_t num_pages,
+                                             int asid) {
+  uint64_t id = m_next_shootdown_id++;
+  uint64_t now = m_m2ndp_config->get_ndp_cycle();
+  // ATS 모드에서 device가 다시 물어볼 host IOTLB부터 무효화
+  m_iommu->invalidate_range(va, num_pages, asid);
+  // kernel launch처럼 M2NDP마다 하나씩 보냄 (BI와 같은 host → device 경로)
+  for (int i = 0; i < m_num_m2ndps; i++) {
+    mem_fetch* mf = new mem_fetch(va & ~0xFFFULL, TLB_ACC_R, READ_REQUEST,
+                                  /*data_size=*/8, CXL_OVERHEAD, 0);
+    mf->set_from_ndp(false);
+    mf->set_tlb_invalidate();
+    mf->set_data(new TlbInvalInfo{id, va, num_pages, asid, now});
+    mf->set_channel(m_m2ndp_config->get_channel_index(mf->get_addr()));
+    m_memory_reqs[0].push(mf);
+  }
+  m_inflight_shootdowns[id] = std::make_pair(now, m_num_m2ndps);
+  m_shootdowns_issued++;
+}
+
+void SimulationRunner::handle_shootdown_ack(mem_fetch* mf) {
+  TlbInvalInfo* info = (TlbInvalInfo*)mf->get_data();
+  auto it = m_inflight_shootdowns.find(info->id);
+  assert(it != m_inflight_shootdowns.end());
+  m_shootdown_entries += info->invalidated;
+  if (--it->second.second == 0) {
+    m_shootdown_latency.add(m_m2ndp_config->get_ndp_cycle() - it->second.first);
+    m_inflight_shootdowns.erase(it);
+  }
+  delete info;
+  delete mf;
+}
+
+// binary memory image(<prefix>.mimg)가 텍스트(<prefix>.data)보다 새로우면 사용
+static std::string memory_map_path(const std::string& prefix) {
+  namespace fs = std::filesystem;
+  std::string image = prefix + ".mimg", text = prefix + ".data";
+  std::error_code ec;
+  if (!fs::exists(image, ec)) return text;
+  if (fs::exists(text, ec) &&
+      fs::last_write_time(image, ec) < fs::last_write_time(text, ec))
+    return text;
+  return image;
+}
+
 void SimulationRunner::parse_ndp_trace() {
   std::ifstream ifs(m_trace_dir_path + "/kernelslist.g");
   std::vector<std::string> kernel_names;
@@ -237,8 +401,10 @@ void SimulationRunner::parse_ndp_trace() {
     if (m_m2ndp_config->is_functional_sim() && cnt == 1 ) { 
       //make input memory map at first kernel
       std::string input_memory_path =
-          m_trace_dir_path + "/" + file_name + "_input.data";
-      m_memory_map = new HashMemoryMap(input_memory_path);
+          memory_map_path(m_trace_dir_path + "/" + file_name + "_input");
+      m_memory_map = MemoryMap::New(m_m2ndp_config->get_memory_map_backend(),
+                                    input_memory_path,
+                                    m_m2ndp_config->get_memory_map_page_size());
       if (m_m2ndp_config->get_use_synthetic_memory())
         m_memory_map->set_synthetic_memory(
             m_m2ndp_config->get_synthetic_base_address(),
@@ -247,8 +413,12 @@ void SimulationRunner::parse_ndp_trace() {
     if (m_m2ndp_config->is_functional_sim() && cnt == num_kernels) {
       //make target memory map at last kernel
       std::string target_memory_path =
-          m_trace_dir_path + "/" + file_name + "_output.data";
-      m_target_map = new HashMemoryMap(target_memory_path);
+          memory_map_path(m_trace_dir_path + "/" + file_name + "_output");
+      m_target_map = MemoryMap::New(m_m2ndp_config->get_memory_map_backend(),
+                                    target_memory_path,
+                                    m_m2ndp_config->get_memory_map_page_size());
+      m_target_map->set_match_report_limit(
+          m_m2ndp_config->get_match_report_limit());
     }
     NdpCommand command = NdpCommand{
         .ndp_kernel_path = m_trace_dir_path + "/" + kernel_name + ".traceg",
@@ -268,11 +438,90 @@ void SimulationRunner::parse_ndp_trace() {
   }
 }
 
+void SimulationRunner::build_page_table() {
+  // 테이블은 memory map에 기록되고 MMU도 거기서 PTE를 읽음
+  if (!m_memory_map) {
+    spdlog::error("build_page_table=1 needs functional_sim=1 (no memory map "
+                  "to write the page table into)");
+    exit(1);
+  }
+  PageTableBuildConfig config;
+  config.policy = PageTableBuildConfig::parse_policy(
+      m_m2ndp_config->get_page_table_policy());
+  config.page_shift = PageTableBuildConfig::parse_page_shift(
+      m_m2ndp_config->get_page_table_page_size());
+  config.pt_base = PAGE_TABLE_BASE;
+  config.frame_base = m_m2ndp_config->get_page_table_frame_base();
+  config.num_colors = m_m2ndp_config->get_page_table_colors();
+  config.seed = m_m2ndp_config->get_page_table_seed();
+  config.placement = PageTableBuildConfig::parse_placement(
+      m_m2ndp_config->get_page_table_placement());
+  config.num_channels = m_m2ndp_config->get_num_channels();
+  M2NDPConfig* m2ndp_config = m_m2ndp_config;
+  config.channel_of = [m2ndp_config](uint64_t addr) {
+    return (int)m2ndp_config->get_channel_index(addr);
+  };
+
+  // replicate: 같은 매핑(같은 seed라 프레임도 같음)을 복제본마다 다른 root에
+  // 만들고, 복제본마다 다른 채널에서 interleave 시작
+  int replicas = m_m2ndp_config->get_num_page_table_replicas();
+  std::vector<PageTableBuilder> builders;
+  builders.reserve(replicas);
+  for (int r = 0; r < replicas; r++) {
+    config.pt_base = PAGE_TABLE_BASE + r * PAGE_TABLE_REPLICA_STRIDE;
+    config.first_channel = r * config.num_channels / replicas;
+    builders.emplace_back(config);
+    PageTableBuilder& builder = builders.back();
+    for (auto& range : m_launch_ranges)
+      builder.add_range(range.first, range.second);
+    if (m_memory_map) builder.add_memory_map(*m_memory_map);
+    if (m_target_map) builder.add_memory_map(*m_target_map);
+    builder.build();
+    builder.write_to(m_memory_map);
+    if (replicas > 1)
+      spdlog::info("Page table replica {}: root {:#x} pages {} tables {}", r,
+                   config.pt_base, builder.get_num_pages(),
+                   builder.get_num_tables());
+  }
+  const PageTableBuilder& builder = builders.front();
+  // 복제본은 같은 VA를 같은 프레임으로 매핑해야 함 (다르면 unit 사이 aliasing)
+  for (const PageTableBuilder& replica : builders) {
+    if (replica.get_num_pages() != builder.get_num_pages() ||
+        replica.get_num_tables() != builder.get_num_tables()) {
+      spdlog::error("Page table replicas differ: pages {} vs {}, tables {} "
+                    "vs {}", replica.get_num_pages(), builder.get_num_pages(),
+                    replica.get_num_tables(), builder.get_num_tables());
+      exit(1);
+    }
+  }
+  spdlog::info("Page table built: policy {} page size {} pages {} tables {} "
+               "placement {} x{}",
+               m_m2ndp_config->get_page_table_policy(),
+               m_m2ndp_config->get_page_table_page_size(),
+               builder.get_num_pages(), builder.get_num_tables(),
+               m_m2ndp_config->get_page_table_placement(), replicas);
+
+  if (!m_m2ndp_config->is_nested_paging_enabled()) return;
+  // 위 테이블을 guest 테이블로 보고, 그 테이블 페이지와 guest 프레임을
+  // 같은 주소의 hPA로 잇는 4KB stage-2 테이블 (gPA == hPA)
+  PageTableBuildConfig s2_config;
+  s2_config.pt_base = m_m2ndp_config->get_stage2_pt_base();
+  PageTableBuilder s2_builder(s2_config);
+  for (const PageTableBuilder& guest : builders)
+    s2_builder.add_guest_physical(guest);
+  s2_builder.build();
+  s2_builder.write_to(m_memory_map);
+  spdlog::info("Stage-2 page table built: base {:#x} pages {} tables {}",
+               s2_config.pt_base, s2_builder.get_num_pages(),
+               s2_builder.get_num_tables());
+}
+
 void SimulationRunner::fill_memory_access(NdpCommand& command,
                                           std::string line) {
   command.memory_reqs.resize(m_num_hosts);
   int host_id = 0;
   KernelLaunchInfo* info = M2NDPParser::parse_kernel_launch(line, host_id);
+  m_launch_ranges.push_back(std::make_pair(info->base_addr, info->size));
   for (int i = 0; i < m_m2ndp_config->get_num_m2ndps(); i++) {
     uint64_t addr = KERNEL_LAUNCH_ADDR;
     mem_fetch* mf = new mem_fetch(addr, DMA_ALLOC_W, WRITE_REQUEST, PACKET_SIZE,
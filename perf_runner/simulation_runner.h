@@ -3,6 +3,9 @@
 #include "cxl_link.h"
 #include "m2ndp_config.h"
 #include "m2ndp.h"
+#include "iommu.h"
+
+#include <map>
 namespace NDPSim {
 struct NdpCommand {
   std::string ndp_kernel_path;
@@ -16,6 +19,7 @@ struct NdpCommand {
 class SimulationRunner {
  public:
   SimulationRunner(int argc, char* argv[]);
+  ~SimulationRunner();
   void run();
   void match_memorymap();
 
@@ -30,6 +34,15 @@ class SimulationRunner {
   void process_memory_access();
   void fill_memory_access(NdpCommand& command, std::string line);
   void generate_uthresds(NdpCommand& command, uint64_t base_addr, uint64_t size);
+  void handle_page_fault(mem_fetch* mf);
+  // 커널 launch 범위와 input/output memory map으로 페이지 테이블 구성
+  void build_page_table();
+  // TLB shootdown: trace(또는 interval)에 따라 M2NDP마다 invalidation을
+  // 보내고, 모든 M2NDP의 ack가 오면 완료
+  void load_tlb_inval_trace();
+  void issue_tlb_invalidations();
+  void send_tlb_invalidation(uint64_t va, uint64_t num_pages, int asid);
+  void handle_shootdown_ack(mem_fetch* mf);
   int m_num_hosts;
   int m_num_m2ndps;
   std::string m_config_file_path;
@@ -45,11 +58,33 @@ class SimulationRunner {
 
   MemoryMap* m_memory_map;
   MemoryMap* m_target_map;
+  // memory_map_restore: 첫 커널 전 input memory map의 snapshot
+  MemoryMap* m_baseline_map = nullptr;
+  int m_num_launched_kernels = 0;
+  // kernel launch들의 (base_addr, size)
+  std::vector<std::pair<uint64_t, uint64_t>> m_launch_ranges;
 
   int remaing_memory_reqs;
   std::vector<std::queue<mem_fetch*>> m_memory_reqs;
   std::queue<NdpCommand> m_ndp_commands;
   std::queue<std::pair<mem_fetch*, uint64_t>> m_bi_reqs;
+  // host가 처리하는 page fault / ATS 요청 (ready cycle -> 응답)
+  std::multimap<uint64_t, mem_fetch*> m_host_translation_reqs;
+  struct TlbInvalEvent {
+    uint64_t cycle;
+    uint64_t va;
+    uint64_t num_pages;
+    int asid;
+  };
+  std::deque<TlbInvalEvent> m_tlb_inval_events;
+  uint64_t m_next_tlb_inval_cycle = 0;
+  uint64_t m_next_shootdown_id = 0;
+  // shootdown id -> (발행 cycle, 남은 ack 수)
+  std::map<uint64_t, std::pair<uint64_t, int>> m_inflight_shootdowns;
+  uint64_t m_shootdowns_issued = 0;
+  uint64_t m_shootdown_entries = 0;
+  LatencyHistogram m_shootdown_latency;
+  Iommu* m_iommu;
 };
 }
 #endif
\ No newline at end of file
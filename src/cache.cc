@@ -393,8 +393,10 @@ CacheRequestStatus TagArray::access(uint64_t addr, uint32_t time, uint32_t &idx,
           wb = true;
           evicted.set_info(m_lines[idx]->get_block_addr(), m_lines[idx]->get_modified_size(),
                            m_lines[idx]->get_status(sector_mask));
+          evicted.m_asid = m_lines[idx]->get_asid();
         }
         m_lines[idx]->allocate(tag, block_addr, time, sector_mask);
+        m_lines[idx]->set_asid(mf->get_asid());
       }
       break;
     case RESERVATION_FAIL:
@@ -405,7 +407,10 @@ CacheRequestStatus TagArray::access(uint64_t addr, uint32_t time, uint32_t &idx,
 }
 
 void TagArray::fill(uint64_t addr, uint32_t time, mem_fetch *mf) {
+  uint32_t idx;
+  bool allocate = probe(addr, idx, mf->get_access_sector_mask()) == MISS;
   fill(addr, time, mf->get_access_sector_mask());
+  if (allocate) m_lines[idx]->set_asid(mf->get_asid());
 }
 
 void TagArray::fill(uint32_t index, uint32_t time, mem_fetch *mf) {
@@ -834,6 +839,7 @@ void DataCache::write_back(EvictedBlockInfo &evicted, uint32_t time, std::deque<
         new mem_fetch(evicted_addr, m_write_back_type, WRITE_REQUEST,
                       PACKET_SIZE, WRITE_PACKET_SIZE, time);
     wb_mf->set_dirty_mask(evicted.m_dirty_mask);
+    wb_mf->set_asid(evicted.m_asid);
     wb_mf->set_channel(m_config.get_m2ndp_config()->get_channel_index(evicted_addr));
     send_write_request(wb_mf, CacheEvent(WRITE_BACK_REQUEST_SENT, evicted),
                        time, events);
@@ -926,6 +932,7 @@ CacheRequestStatus DataCache::wr_miss_wa_naive(uint64_t addr,
       mf->get_ctrl_size(), mf->get_access_byte_mask(),
       mf->get_access_sector_mask(), time);
   new_mf->set_channel(mf->get_channel());
+  new_mf->set_asid(mf->get_asid());
   bool do_miss = false;
   bool wb = false;
   EvictedBlockInfo evicted;
@@ -998,6 +1005,7 @@ CacheRequestStatus DataCache::wr_miss_wa_fetch_on_write(
         mf->get_ctrl_size(), mf->get_access_byte_mask(),
         mf->get_access_sector_mask(), time);
     new_mf->set_channel(mf->get_channel());
+    new_mf->set_asid(mf->get_asid());
     bool do_miss = false;
     bool wb = false;
     EvictedBlockInfo evicted;
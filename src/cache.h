@@ -107,10 +107,14 @@ class CacheBlock {
   virtual void set_readable(bool readable, SectorMask sector_mask) = 0;
   virtual void set_last_access_time(uint64_t time, SectorMask sector_mask) = 0;
   virtual uint32_t get_modified_size() = 0;
+  // 라인을 할당한 요청의 ASID (evict된 라인의 write-back 변환용)
+  void set_asid(int asid) { m_asid = asid; }
+  int get_asid() const { return m_asid; }
 
  protected:
   uint64_t m_tag;
   uint64_t m_block_addr;
+  int m_asid = 0;
 };
 
 class LineCacheBlock : public CacheBlock {
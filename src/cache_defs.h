@@ -45,6 +45,7 @@ struct EvictedBlockInfo {
   uint64_t m_block_addr = 0;
   uint32_t m_modified_size = 0;
   SectorMask m_dirty_mask;
+  int m_asid = 0;  // write-back을 변환할 address space (L1은 VA 캐시)
   void set_info(uint64_t block_addr, uint32_t modified_size,
                 SectorMask dirty_mask) {
     m_block_addr = block_addr;
@@ -12,6 +12,7 @@
 
 #include "common_defs.h"
 #include "ndp_instruction.h"
+#include "page_table.h"
 #include "vector_data.h"
 namespace NDPSim {
 class mem_fetch;
@@ -55,6 +56,9 @@ struct KernelLaunchInfo {
   std::string kernel_name;
   mem_fetch* cxl_command;
   MemoryMap* scratchpad_map;
+  // address space: launch line의 PT_BASE/ASID (ASID -1이면 M2NDP가 할당)
+  uint64_t pt_base = PAGE_TABLE_BASE;
+  int asid = -1;
 };
 
 class VectorData;
@@ -69,6 +73,7 @@ struct RequestInfo {
   uint64_t addr;
   uint64_t offset;
   MemoryMap* scratchpad_map;
+  int asid = 0;
 };
 
 class MemoryMap;
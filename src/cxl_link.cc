@@ -105,7 +105,8 @@ void CxlLink::push_from_memory_buffer(int buffer_id, int node_no,
                buffer_id * m_num_connections + offset;
   id = buffer_id; // TODO: remove this for other topology
   out_id = node_no; // TODO: remove this for other topology
-  if (mf->get_addr() != KERNEL_LAUNCH_ADDR && mf->get_from_ndp() && !mf->is_bi()) {
+  if (mf->get_addr() != KERNEL_LAUNCH_ADDR && mf->get_from_ndp() && !mf->is_bi() &&
+      !mf->is_host_translation()) {
     if (!mf->is_request()) {
       if (mf->get_addr() == 0x90000000000)
         spdlog::info("[{}] : from M2NDP{} to M2NDP{}", mem_access_type_str[mf->get_type()], buffer_id, (int)((mf->get_ndp_id() / m_m2ndp_config->get_num_m2ndps())));
@@ -146,6 +146,7 @@ void InstructionQueue::cycle() {
       mf->set_from_ndp(true);
       mf->set_ndp_id(m_id);
       mf->set_sub_core_id(m_sub_core_id);
+      mf->set_asid((*iter)->req->asid);
       mf->set_inst_column(*iter);
       mf->set_channel(m_config->get_channel_index(inst_addr));
       m_icache_queue.push(mf, m_l0_icache_hit_latency); //TODO: l0 icache hit latency
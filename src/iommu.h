@@ -0,0 +1,76 @@
+#ifdef TIMING_SIMULATION
+#ifndef IOMMU_H
+#define IOMMU_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+
+#include "cache.h"
+#include "m2ndp_config.h"
+#include "page_table.h"
+#include "tlb_array.h"
+
+namespace NDPSim {
+
+class MemoryMap;
+
+// NDP → host ATS translation request/completion (mem_fetch data로 전달).
+// 요청 시 va/pt_base/asid/is_write를 채우고, host가 결과를 채워서 돌려준다.
+struct AtsInfo {
+  uint64_t va;
+  uint64_t pt_base;
+  int asid = 0;  // IOTLB tag
+  bool is_write;
+  uint64_t issue_cycle;
+  // completion
+  bool success = false;
+  uint64_t pa = 0;
+  uint32_t page_shift = 12;
+};
+
+// host IOMMU stand-in. page table이 host 메모리에 있다고 보고 IOTLB와
+// 고정 walk latency로 ATS 요청에 응답한다. demand paging이 켜져 있으면
+// not-present 페이지는 host fault handler가 매핑한 뒤 응답한다.
+// host 쪽 page table(PageTable)은 pt_base 별로 여기서 관리한다.
+class Iommu {
+ public:
+  Iommu(M2NDPConfig* config, MemoryMap* mem);
+  ~Iommu();
+
+  // info에 변환 결과를 채우고 응답을 보낼 수 있는 cycle을 반환
+  uint64_t translate(AtsInfo* info, uint64_t now);
+
+  // host fault handler: 폴트 난 4KB 페이지를 identity로 매핑
+  void handle_page_fault(uint64_t va, uint64_t pt_base);
+
+  // host 쪽 shootdown: [va, va + num_pages * 4KB)의 IOTLB 엔트리를
+  // asid(< 0이면 전부)에서 무효화, 무효화한 수 반환
+  int invalidate_range(uint64_t va, uint64_t num_pages, int asid);
+  // IOTLB 전체 무효화
+  void flush();
+
+  PageTable* get_page_table(uint64_t pt_base);
+  void print_stats(FILE* fp);
+
+ private:
+  M2NDPConfig* m_config;
+  MemoryMap* m_mem;
+
+  CacheConfig m_iotlb_config;
+  TlbArray* m_iotlb = nullptr;
+  int m_walk_latency;
+
+  std::map<uint64_t, PageTable*> m_page_tables;  // pt_base -> page table
+
+  uint64_t m_requests = 0;
+  uint64_t m_walks = 0;
+  uint64_t m_page_faults = 0;
+  uint64_t m_failed = 0;
+  uint64_t m_invalidated = 0;
+  uint64_t m_latency_sum = 0;
+};
+
+}  // namespace NDPSim
+#endif
+#endif  // TIMING_SIMULATION
@@ -183,6 +183,8 @@ void LDSTUnit::process_ldst_inst(ExecutionDelayQueue &ldst_unit) {
                         m_config->get_packet_size(), CXL_OVERHEAD, m_cycle);
       mf->set_from_ndp(true);
       mf->set_ndp_id(m_ndp_id);
+      mf->set_sub_core_id(context.sub_core_id);
+      mf->set_asid(context.request_info->asid);
       mf->set_channel(m_config->get_channel_index(addr));
       if (m_config->is_bi_enabled()) {
         if (rand() % 100 < (m_config->get_bi_rate() * 100) &&
@@ -233,6 +235,8 @@ void LDSTUnit::process_ldst_inst(ExecutionDelayQueue &ldst_unit) {
                         m_config->get_packet_size(), CXL_OVERHEAD, m_cycle);
       mf->set_from_ndp(true);
       mf->set_ndp_id(m_ndp_id);
+      mf->set_sub_core_id(context.sub_core_id);
+      mf->set_asid(context.request_info->asid);
       mf->set_channel(m_config->get_channel_index(addr));
       if (m_config->is_bi_enabled()) {
         if (rand() % 100 < (m_config->get_bi_rate() * 100) &&
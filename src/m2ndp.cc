@@ -52,6 +52,16 @@ M2NDP::M2NDP(M2NDPConfig *config, MemoryMap *memory_map,
     m_ndp_stats[i].set_num_sub_core(m_config->get_num_sub_core());
     m_ndp_units[i] = new NdpUnit(m_config, m_memory_map, &m_ndp_stats[i], id);
   }
+  if (m_config->is_ats_enabled() && !m_config->get_atc_config().empty()) {
+    m_atc_config.init(m_config->get_atc_config(), m_config);
+    m_atc = new TlbArray("atc", m_atc_config, m_config->get_atc_hit_latency());
+    for (int i = 0; i < m_num_ndp_units; i++) m_ndp_units[i]->set_atc(m_atc);
+  }
+  if (!m_config->get_shared_tlb_config().empty()) {
+    m_shared_tlb = new SharedTlb(m_config, m_num_ndp_units);
+    for (int i = 0; i < m_num_ndp_units; i++)
+      m_ndp_units[i]->set_shared_tlb(m_shared_tlb, i);
+  }
   m_total_stats.set_num_sub_core(m_config->get_num_sub_core());
   m_ndp_kernels.resize(m_config->m_num_hosts);
   m_host_round_robin.resize(m_config->m_num_hosts);
@@ -84,6 +94,7 @@ void M2NDP::cycle() {
   }
 
   if (m_config->is_buffer_ndp_cycle()) {
+    if (m_shared_tlb) m_shared_tlb->cycle();
     // NDP to ICNT
     for (int i = 0; i < m_num_ndp_units; i++) {
       for (int bank = 0; bank < m_config->get_l2d_num_banks(); bank++) {
@@ -204,6 +215,7 @@ bool M2NDP::is_active() {
     active = active || is_launch_active(i) || m_cxl_link->is_active() ||
              m_ramulator->is_active();
   }
+  active = active || !m_pending_shootdowns.empty();
   return active;
 }
 
@@ -235,6 +247,28 @@ void M2NDP::display_stats(FILE *fp) {
   }
   fprintf(fp, "======= Total NDP ======\n");
   m_total_stats.print_stats(fp);
+  fprintf(fp, "======= Translation per NDP unit ======\n");
+  for (int i = 0; i < m_num_ndp_units; i++) {
+    fprintf(fp, "NDP unit %d: %s\n", i,
+            NdpStats::translation_summary(
+                m_ndp_stats[i].get_translation_counters()).c_str());
+  }
+  if (m_atc) m_atc->get_stats().print_stats(fp, "ATC");
+  if (m_shared_tlb) m_shared_tlb->print_stats(fp);
+  fprintf(fp, "asid_rebind_flushes: %lu\n", m_asid_flushes);
+  fprintf(fp, "asid_switch_flushes: %lu\n", m_switch_flushes);
+  if (m_shootdowns) {
+    fprintf(fp, "tlb_shootdowns: %lu (invalidated entries %lu)\n",
+            m_shootdowns, m_shootdown_entries);
+    m_shootdown_latency.print_stats(fp, "tlb shootdown drain latency");
+  }
+}
+
+TranslationCounters M2NDP::get_translation_counters() {
+  TranslationCounters total;
+  for (int i = 0; i < m_num_ndp_units; i++)
+    total += m_ndp_units[i]->get_translation_counters();
+  return total;
 }
 
 void M2NDP::print_energy_stats(FILE *fp) {
@@ -257,18 +291,146 @@ void M2NDP::launch_ndp_kernel(int host_id, KernelLaunchInfo info) {
   int launch_id = global_launch_id++;
   info.launch_id = launch_id;
   info.kernel_name = get_kernel_name(host_id, info.kernel_id);
+  assign_asid(info);
   m_launch_infos.push_back(info);
   for (int i = 0; i < m_num_ndp_units; i++) {
     int ndp_id = get_ndp_id(i);
     m_ndp_units[i]->launch_ndp_kernel(info);
   }
+  m_launch_translation[launch_id] = get_translation_counters();
   spdlog::info("Gate info: host {} launched NDP kernel {} launch id {} at core cycle {} ndp "
                "cycle {} to CXL {}",
                host_id, info.kernel_name, launch_id, m_config->get_sim_cycle(),
                m_config->get_ndp_cycle(), m_buffer_id);
 }
 
+void M2NDP::assign_asid(KernelLaunchInfo &info) {
+  int num_asids = m_config->get_tlb_num_asids();
+  if (info.asid < 0) {
+    // 같은 page table을 쓰는 ASID가 있으면 그대로 재사용
+    for (auto &[asid, pt_base] : m_asid_pt_base) {
+      if (pt_base == info.pt_base) {
+        info.asid = asid;
+        break;
+      }
+    }
+  }
+  if (info.asid < 0 && info.pt_base == PAGE_TABLE_BASE &&
+      !m_asid_pt_base.count(0))
+    info.asid = 0;
+  if (info.asid < 0) {
+    // 실행 중인 launch가 쓰지 않는 ASID를 round-robin으로 고름
+    for (int i = 0; i < num_asids - 1 && info.asid < 0; i++) {
+      int asid = m_next_asid;
+      m_next_asid = m_next_asid + 1 < num_asids ? m_next_asid + 1 : 1;
+      if (!is_asid_active(asid)) info.asid = asid;
+    }
+    if (info.asid < 0) {
+      spdlog::error("No free ASID for launch {} (tlb_num_asids {})",
+                    info.launch_id, num_asids);
+      exit(1);
+    }
+  }
+  if (info.asid >= num_asids) {
+    spdlog::error("ASID {} exceeds tlb_num_asids {}", info.asid, num_asids);
+    exit(1);
+  }
+
+  auto it = m_asid_pt_base.find(info.asid);
+  if (it != m_asid_pt_base.end() && it->second != info.pt_base) {
+    if (is_asid_active(info.asid)) {
+      spdlog::error("ASID {} is in use with pt_base 0x{:x}", info.asid,
+                    it->second);
+      exit(1);
+    }
+    // 다른 page table로 재사용: 남아 있는 이전 변환을 지움
+    flush_asid(info.asid);
+    m_asid_flushes++;
+  }
+  m_asid_pt_base[info.asid] = info.pt_base;
+  for (int i = 0; i < m_num_ndp_units; i++)
+    m_ndp_units[i]->bind_address_space(info.asid,
+                                       page_table_root(info.pt_base, i));
+
+  if (m_config->get_tlb_asid_mode() == "flush" && m_cur_asid >= 0 &&
+      m_cur_asid != info.asid) {
+    flush_tlbs();
+    m_switch_flushes++;
+  }
+  m_cur_asid = info.asid;
+}
+
+uint64_t M2NDP::page_table_root(uint64_t pt_base, int unit) {
+  // replicate: 시뮬레이터가 만든 테이블(PAGE_TABLE_BASE)만 복제본이 있음
+  int replicas = m_config->get_num_page_table_replicas();
+  if (replicas <= 1 || !m_config->is_build_page_table() ||
+      pt_base != PAGE_TABLE_BASE)
+    return pt_base;
+  return pt_base + (unit % replicas) * PAGE_TABLE_REPLICA_STRIDE;
+}
+
+bool M2NDP::is_asid_active(int asid) {
+  for (auto &launch_info : m_launch_infos)
+    if (launch_info.asid == asid) return true;
+  return false;
+}
+
+void M2NDP::flush_asid(int asid) {
+  for (int i = 0; i < m_num_ndp_units; i++) m_ndp_units[i]->flush_asid(asid);
+  if (m_shared_tlb) m_shared_tlb->flush_asid(asid);
+  if (m_atc) m_atc->flush_asid(asid);
+}
+
+void M2NDP::flush_tlbs() {
+  for (int i = 0; i < m_num_ndp_units; i++) m_ndp_units[i]->flush_tlbs();
+  if (m_shared_tlb) m_shared_tlb->flush();
+  if (m_atc) m_atc->flush();
+}
+
+void M2NDP::receive_shootdown(mem_fetch *mf, int link) {
+  TlbInvalInfo *info = (TlbInvalInfo *)mf->get_data();
+  info->invalidated += invalidate_range(info);
+  PendingShootdown pending{mf, link, m_config->get_ndp_cycle(), {}};
+  for (int i = 0; i < m_num_ndp_units; i++)
+    pending.walk_seqs.push_back(m_ndp_units[i]->get_walk_seq());
+  m_pending_shootdowns.push_back(pending);
+}
+
+int M2NDP::invalidate_range(TlbInvalInfo *info) {
+  int count = 0;
+  for (uint64_t p = 0; p < info->num_pages; p++) {
+    uint64_t va = (info->va & ~0xFFFULL) + (p << 12);
+    for (int i = 0; i < m_num_ndp_units; i++)
+      count += m_ndp_units[i]->invalidate_va(info->asid, va);
+    if (m_shared_tlb) count += m_shared_tlb->invalidate_va(info->asid, va);
+    if (m_atc) count += m_atc->invalidate_va(info->asid, va);
+  }
+  return count;
+}
+
+void M2NDP::check_shootdowns() {
+  for (auto it = m_pending_shootdowns.begin();
+       it != m_pending_shootdowns.end();) {
+    bool drained = true;
+    for (int i = 0; i < m_num_ndp_units && drained; i++)
+      drained = m_ndp_units[i]->walks_drained(it->walk_seqs[i]);
+    if (!drained) {
+      ++it;
+      continue;
+    }
+    TlbInvalInfo *info = (TlbInvalInfo *)it->mf->get_data();
+    info->invalidated += invalidate_range(info);
+    m_shootdowns++;
+    m_shootdown_entries += info->invalidated;
+    m_shootdown_latency.add(m_config->get_ndp_cycle() - it->recv_cycle);
+    it->mf->set_reply();
+    m_cxl_command_response[it->link].push_back(it->mf);
+    it = m_pending_shootdowns.erase(it);
+  }
+}
+
 void M2NDP::transfer_cxl_to_memory() {
+  if (!m_pending_shootdowns.empty()) check_shootdowns();
 
   for(int i = 0; i < m_ndp_stats.size(); i++) {
     if(m_uthread_reqs[i] > 0) {
@@ -290,6 +452,10 @@ void M2NDP::transfer_cxl_to_memory() {
         m_cxl_link->pop_from_memory_buffer(m_buffer_id, i);
         delete mf;
       }
+      else if (mf && mf->is_tlb_invalidate()) {
+        m_cxl_link->pop_from_memory_buffer(m_buffer_id, i);
+        receive_shootdown(mf, i);
+      }
       else if (mf && mf->get_addr() == KERNEL_LAUNCH_ADDR) {
         KernelLaunchInfo *info = (KernelLaunchInfo *)mf->get_data();
         m_cxl_link->pop_from_memory_buffer(m_buffer_id, i);
@@ -366,6 +532,13 @@ void M2NDP::check_kernel_active() {
           "cycle {} at CXL {}",
           launch_info.host_id, launch_info.kernel_name, launch_info.launch_id,
           m_config->get_sim_cycle(), m_config->get_ndp_cycle(), m_buffer_id);
+      // 동시에 돈 커널이 있으면 그 변환도 같이 잡힘
+      spdlog::info("Translation info: NDP kernel {} launch id {}: {}",
+                   launch_info.kernel_name, launch_info.launch_id,
+                   NdpStats::translation_summary(
+                       get_translation_counters() -
+                       m_launch_translation[launch_info.launch_id]));
+      m_launch_translation.erase(launch_info.launch_id);
       if (iter->sync) {
         launch_info.cxl_command->set_reply();
         int get_output_id = get_output_port_id(launch_info.cxl_command);
@@ -408,13 +581,14 @@ int M2NDP::get_output_port_id(mem_fetch *mf) {
       return (channel_dest * m_num_banks + bank_id) % link_per_host;
     }
   }
-  if (mf->is_request() && !mf->is_bi()) {
+  if (mf->is_request() && !mf->is_bi() && !mf->is_host_translation()) {
     return cxl_port_offset + ndp_port_offset + channel_dest * m_num_banks +
            bank_id;
   } else if (mf->get_from_ndp() && !mf->is_request()) {
     return cxl_port_offset + channel_dest * m_num_banks + bank_id;
   } else if ((!mf->get_from_ndp() && !mf->is_request()) 
-    || (mf->is_bi() && mf->is_request())) { // route back-invaildate request to host
+    || (mf->is_bi() && mf->is_request())  // route back-invaildate request to host
+    || (mf->is_host_translation() && mf->is_request())) { // page fault / ATS to host
     int host_id = mf->get_host_id();
     return host_id * link_per_host +
            (channel_dest * m_num_banks + bank_id) % link_per_host;
@@ -6,6 +6,8 @@
 #include "ndp_ramulator.h"
 #include "m2ndp_config.h"
 #include "common.h"
+#include "tlb_array.h"
+#include "shared_tlb.h"
 namespace NDPSim {
 
 class M2NDP {
@@ -22,6 +24,8 @@ class M2NDP {
   void display_stats(FILE *fp);
   void print_energy_stats(FILE *fp);
   void print_access_time(FILE *fp);
+  // 모든 변환 구조 비우기: unit별 L1/STLB/PWC/prefetch buffer, shared TLB, ATC
+  void flush_tlbs();
 
  private:
   int m_buffer_id;
@@ -44,11 +48,38 @@ class M2NDP {
   std::vector<int> m_host_round_robin;
   std::vector<std::vector<NdpKernel*>> m_ndp_kernels;
   std::vector<KernelLaunchInfo> m_launch_infos;
+  // launch id -> launch 시점의 변환 카운터 (종료 시 차이를 커널 통계로 출력)
+  std::map<int, TranslationCounters> m_launch_translation;
 
   std::vector<NdpUnit*> m_ndp_units;
   std::vector<NdpStats> m_ndp_stats;
   NdpStats m_total_stats;
 
+  // ATS 모드: NDP unit들이 공유하는 device-side ATC
+  CacheConfig m_atc_config;
+  TlbArray *m_atc = nullptr;
+  // NDP unit들이 local crossbar 너머로 공유하는 last-level TLB
+  SharedTlb *m_shared_tlb = nullptr;
+  // ASID -> page table base (launch마다 pt_base별로 ASID 할당)
+  std::map<int, uint64_t> m_asid_pt_base;
+  int m_next_asid = 1;
+  int m_cur_asid = -1;
+  uint64_t m_asid_flushes = 0;   // ASID 재사용/재바인딩 시 선택적 무효화
+  uint64_t m_switch_flushes = 0; // flush 모드: ASID 전환 시 전체 무효화
+
+  // host TLB shootdown: 무효화 후 그 시점까지 제출된 walk가 모두 끝나면
+  // 같은 범위를 한 번 더 무효화하고 (drain 중 설치된 엔트리) ack
+  struct PendingShootdown {
+    mem_fetch *mf;
+    int link;
+    uint64_t recv_cycle;
+    std::vector<uint64_t> walk_seqs;  // NDP unit별
+  };
+  std::deque<PendingShootdown> m_pending_shootdowns;
+  uint64_t m_shootdowns = 0;
+  uint64_t m_shootdown_entries = 0;
+  LatencyHistogram m_shootdown_latency;  // 수신 → ack
+
   std::vector<std::deque<mem_fetch*>> m_cxl_command_response;
 
   int *rr_index;
@@ -57,9 +88,17 @@ class M2NDP {
 
   std::string get_kernel_name(int host_id, int kernel_id);
   void launch_ndp_kernel(int host_id, KernelLaunchInfo launch_info);
+  void assign_asid(KernelLaunchInfo &info);
+  uint64_t page_table_root(uint64_t pt_base, int unit);
+  bool is_asid_active(int asid);
+  void flush_asid(int asid);
+  void receive_shootdown(mem_fetch *mf, int link);
+  int invalidate_range(TlbInvalInfo *info);
+  void check_shootdowns();
   void transfer_cxl_to_memory();
   void transfer_memory_to_cxl();
   void check_kernel_active();
+  TranslationCounters get_translation_counters();
 
   int get_ndp_id(int index);
   int get_output_port_id(mem_fetch* mf);
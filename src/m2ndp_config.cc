@@ -196,6 +196,56 @@ void M2NDPConfig::print_config(FILE *fp) {
   fprintf(fp, "tlb_entry_size:\t %d\n", m_tlb_entry_size);
   fprintf(fp, "itlb_config:\t %s\n", m_itlb_config.c_str());
   fprintf(fp, "dtlb_config:\t %s\n", m_dtlb_config.c_str());
+  fprintf(fp, "stlb_config:\t %s\n", m_stlb_config.c_str());
+  fprintf(fp, "stlb_hit_latency:\t %d\n", m_stlb_hit_latency);
+  fprintf(fp, "num_page_walkers:\t %d\n", m_num_page_walkers);
+  fprintf(fp, "page_walk_queue_size:\t %d\n", m_page_walk_queue_size);
+  fprintf(fp, "ptw_issue_rate:\t %d\n", m_ptw_issue_rate);
+  fprintf(fp, "enable_demand_paging:\t %d\n", m_enable_demand_paging);
+  fprintf(fp, "page_fault_latency:\t %d\n", m_page_fault_latency);
+  fprintf(fp, "enable_ats:\t %d\n", m_enable_ats);
+  fprintf(fp, "atc_config:\t %s\n", m_atc_config.c_str());
+  fprintf(fp, "atc_hit_latency:\t %d\n", m_atc_hit_latency);
+  fprintf(fp, "iommu_iotlb_config:\t %s\n", m_iommu_iotlb_config.c_str());
+  fprintf(fp, "iommu_iotlb_hit_latency:\t %d\n", m_iommu_iotlb_hit_latency);
+  fprintf(fp, "iommu_walk_latency:\t %d\n", m_iommu_walk_latency);
+  fprintf(fp, "shared_tlb_config:\t %s\n", m_shared_tlb_config.c_str());
+  fprintf(fp, "shared_tlb_banks:\t %d\n", m_shared_tlb_banks);
+  fprintf(fp, "shared_tlb_ports:\t %d\n", m_shared_tlb_ports);
+  fprintf(fp, "shared_tlb_hit_latency:\t %d\n", m_shared_tlb_hit_latency);
+  fprintf(fp, "shared_tlb_xbar_latency:\t %d\n", m_shared_tlb_xbar_latency);
+  fprintf(fp, "tlb_coalesce_pages:\t %d\n", m_tlb_coalesce_pages);
+  fprintf(fp, "tlb_prefetch_degree:\t %d\n", m_tlb_prefetch_degree);
+  fprintf(fp, "tlb_prefetch_buffer_entries:\t %d\n", m_tlb_prefetch_buffer_entries);
+  fprintf(fp, "tlb_prefetch_throttle:\t %d\n", m_tlb_prefetch_throttle);
+  fprintf(fp, "pte_ad_update:\t %d\n", m_pte_ad_update);
+  fprintf(fp, "uthread_tlb_aware:\t %d\n", m_uthread_tlb_aware);
+  fprintf(fp, "uthread_tlb_window:\t %d\n", m_uthread_tlb_window);
+  fprintf(fp, "build_page_table:\t %d\n", m_build_page_table);
+  fprintf(fp, "page_table_policy:\t %s\n", m_page_table_policy.c_str());
+  fprintf(fp, "page_table_page_size:\t %lu\n", m_page_table_page_size);
+  fprintf(fp, "page_table_frame_base:\t 0x%lx\n", m_page_table_frame_base);
+  fprintf(fp, "page_table_colors:\t %d\n", m_page_table_colors);
+  fprintf(fp, "page_table_seed:\t %d\n", m_page_table_seed);
+  fprintf(fp, "page_table_placement:\t %s\n", m_page_table_placement.c_str());
+  fprintf(fp, "page_table_replicas:\t %d\n", m_page_table_replicas);
+  fprintf(fp, "tlb_asid_mode:\t %s\n", m_tlb_asid_mode.c_str());
+  fprintf(fp, "tlb_num_asids:\t %d\n", m_tlb_num_asids);
+  fprintf(fp, "nested_paging:\t %d\n", m_nested_paging);
+  fprintf(fp, "stage2_pt_base:\t 0x%lx\n", m_stage2_pt_base);
+  fprintf(fp, "nested_tlb_config:\t %s\n", m_nested_tlb_config.c_str());
+  fprintf(fp, "stage2_pwc_config:\t %s\n", m_stage2_pwc_config.c_str());
+  fprintf(fp, "tlb_inval_trace:\t %s\n", m_tlb_inval_trace.c_str());
+  fprintf(fp, "tlb_inval_interval:\t %d\n", m_tlb_inval_interval);
+  fprintf(fp, "tlb_inval_pages:\t %d\n", m_tlb_inval_pages);
+  fprintf(fp, "tlb_vector_batch:\t %d\n", m_tlb_vector_batch);
+  fprintf(fp, "memory_map_backend:\t %s\n", m_memory_map_backend.c_str());
+  fprintf(fp, "memory_map_page_size:\t %lu\n", m_memory_map_page_size);
+  fprintf(fp, "match_report_limit:\t %d\n", m_match_report_limit);
+  fprintf(fp, "memory_map_restore:\t %d\n", m_memory_map_restore);
+  fprintf(fp, "pml4e_cache_config:\t %s\n", m_pml4e_cache_config.c_str());
+  fprintf(fp, "pdpte_cache_config:\t %s\n", m_pdpte_cache_config.c_str());
+  fprintf(fp, "pde_cache_config:\t %s\n", m_pde_cache_config.c_str());
   fprintf(fp, "request_queue_size:\t %d\n", m_request_queue_size);
   fprintf(fp, "max_dma_list_size:\t %d\n", m_max_dma_list_size);
   fprintf(fp, "uthread_slots:\t %d\n", m_uthread_slots);
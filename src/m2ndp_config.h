@@ -113,6 +113,61 @@ class M2NDPConfig {
   const std::string get_dtlb_config() { return m_dtlb_config; }
   const std::string get_itlb_config() { return m_itlb_config; }
   const int get_tlb_hit_latency() { return m_tlb_hit_latency; }
+  const std::string get_stlb_config() { return m_stlb_config; }
+  const int get_stlb_hit_latency() { return m_stlb_hit_latency; }
+  const std::string get_pml4e_cache_config() { return m_pml4e_cache_config; }
+  const std::string get_pdpte_cache_config() { return m_pdpte_cache_config; }
+  const std::string get_pde_cache_config() { return m_pde_cache_config; }
+  const int get_num_page_walkers() { return m_num_page_walkers; }
+  const int get_page_walk_queue_size() { return m_page_walk_queue_size; }
+  const int get_ptw_issue_rate() { return m_ptw_issue_rate; }
+  const bool is_demand_paging_enabled() { return m_enable_demand_paging; }
+  const int get_page_fault_latency() { return m_page_fault_latency; }
+  const bool is_ats_enabled() { return m_enable_ats; }
+  const std::string get_atc_config() { return m_atc_config; }
+  const int get_atc_hit_latency() { return m_atc_hit_latency; }
+  const std::string get_iommu_iotlb_config() { return m_iommu_iotlb_config; }
+  const int get_iommu_iotlb_hit_latency() { return m_iommu_iotlb_hit_latency; }
+  const int get_iommu_walk_latency() { return m_iommu_walk_latency; }
+  const std::string get_shared_tlb_config() { return m_shared_tlb_config; }
+  const int get_shared_tlb_banks() { return m_shared_tlb_banks; }
+  const int get_shared_tlb_ports() { return m_shared_tlb_ports; }
+  const int get_shared_tlb_hit_latency() { return m_shared_tlb_hit_latency; }
+  const int get_shared_tlb_xbar_latency() { return m_shared_tlb_xbar_latency; }
+  const int get_tlb_coalesce_pages() { return m_tlb_coalesce_pages; }
+  const int get_tlb_prefetch_degree() { return m_tlb_prefetch_degree; }
+  const int get_tlb_prefetch_buffer_entries() { return m_tlb_prefetch_buffer_entries; }
+  const int get_tlb_prefetch_throttle() { return m_tlb_prefetch_throttle; }
+  const bool is_pte_ad_update_enabled() { return m_pte_ad_update; }
+  const bool is_uthread_tlb_aware() { return m_uthread_tlb_aware; }
+  const int get_uthread_tlb_window() { return m_uthread_tlb_window; }
+  const bool is_build_page_table() { return m_build_page_table; }
+  const std::string get_page_table_policy() { return m_page_table_policy; }
+  const uint64_t get_page_table_page_size() { return m_page_table_page_size; }
+  const uint64_t get_page_table_frame_base() { return m_page_table_frame_base; }
+  const int get_page_table_colors() { return m_page_table_colors; }
+  const int get_page_table_seed() { return m_page_table_seed; }
+  const std::string get_page_table_placement() { return m_page_table_placement; }
+  // replicate가 아니면 1 (복제본 0 = 원본 테이블)
+  const int get_num_page_table_replicas() {
+    if (m_page_table_placement != "replicate") return 1;
+    return m_page_table_replicas > 0 ? m_page_table_replicas
+                                     : m_ndp_units_per_buffer;
+  }
+  const std::string get_tlb_asid_mode() { return m_tlb_asid_mode; }
+  const int get_tlb_num_asids() { return m_tlb_num_asids; }
+  const bool is_nested_paging_enabled() { return m_nested_paging; }
+  const uint64_t get_stage2_pt_base() { return m_stage2_pt_base; }
+  const std::string get_nested_tlb_config() { return m_nested_tlb_config; }
+  const std::string get_stage2_pwc_config() { return m_stage2_pwc_config; }
+  const std::string get_tlb_inval_trace() { return m_tlb_inval_trace; }
+  const int get_tlb_inval_interval() { return m_tlb_inval_interval; }
+  const int get_tlb_inval_pages() { return m_tlb_inval_pages; }
+  const bool is_tlb_vector_batch() { return m_tlb_vector_batch; }
+  const std::string get_memory_map_backend() { return m_memory_map_backend; }
+  const uint64_t get_memory_map_page_size() { return m_memory_map_page_size; }
+  const int get_match_report_limit() { return m_match_report_limit; }
+  const bool is_memory_map_restore() { return m_memory_map_restore; }
   const int get_max_kernel_register() { return m_max_kernel_register; }
   const int get_max_kernel_launch() { return m_max_kernel_launch; }
   const int get_max_dma_list_size() { return m_max_dma_list_size; }
@@ -267,6 +322,92 @@ class M2NDPConfig {
   int m_tlb_entry_size;
   std::string m_dtlb_config;
   std::string m_itlb_config;
+  // Shared L2 TLB per NDP unit (cache config format, empty = disabled)
+  std::string m_stlb_config;
+  int m_stlb_hit_latency = 8;
+  // Page-walk cache configuration (entries:assoc:latency, empty = disabled)
+  std::string m_pml4e_cache_config;
+  std::string m_pdpte_cache_config;
+  std::string m_pde_cache_config;
+  // Page walker pool (0 = unlimited)
+  int m_num_page_walkers = 0;
+  int m_page_walk_queue_size = 0;
+  int m_ptw_issue_rate = 0;
+  // Demand paging: not-present PTE raises a page fault to the host
+  bool m_enable_demand_paging = false;
+  int m_page_fault_latency = 10000;
+  // ATS mode: TLB miss goes to the host IOMMU instead of a local walk.
+  // Device-side ATC is shared per M2NDP (cache config format, empty = none)
+  bool m_enable_ats = false;
+  std::string m_atc_config;
+  int m_atc_hit_latency = 4;
+  std::string m_iommu_iotlb_config;
+  int m_iommu_iotlb_hit_latency = 10;
+  int m_iommu_walk_latency = 300;
+  // Shared last-level TLB per M2NDP (per-bank cache config, empty = disabled)
+  std::string m_shared_tlb_config;
+  int m_shared_tlb_banks = 4;
+  int m_shared_tlb_ports = 1;
+  int m_shared_tlb_hit_latency = 10;
+  int m_shared_tlb_xbar_latency = 4;
+  // Coalesced 4KB TLB entries: aligned group size in pages (1 = disabled)
+  int m_tlb_coalesce_pages = 1;
+  // TLB prefetcher in the MMU (degree 0 = disabled). Throttle is the walker
+  // occupancy (%) above which no prefetch walk is started
+  int m_tlb_prefetch_degree = 0;
+  int m_tlb_prefetch_buffer_entries = 16;
+  int m_tlb_prefetch_throttle = 75;
+  // Update leaf PTE accessed/dirty bits with locked RMWs through the L2
+  bool m_pte_ad_update = false;
+  // Translation-aware uthread scheduling: look this many pending uthreads
+  // ahead for one whose page is already in the DTLB/STLB
+  bool m_uthread_tlb_aware = false;
+  int m_uthread_tlb_window = 32;
+  // Build the page table in the simulator at startup instead of loading a
+  // make_pt.py image (policy: identity / random / coloring)
+  bool m_build_page_table = false;
+  std::string m_page_table_policy = "identity";
+  uint64_t m_page_table_page_size = 4096;
+  uint64_t m_page_table_frame_base = 0;
+  int m_page_table_colors = 16;
+  int m_page_table_seed = 1;
+  // Where built page-table pages go across DRAM channels: contiguous from
+  // pt_base, interleave (round robin), colocate (with the data they map) or
+  // replicate (one interleaved copy per NDP unit, 0 replicas = units/buffer)
+  std::string m_page_table_placement = "contiguous";
+  int m_page_table_replicas = 0;
+  // Multi-tenant translation: "tagged" keeps ASID-tagged TLB/PWC entries
+  // across launches, "flush" flushes them whenever the running ASID changes
+  std::string m_tlb_asid_mode = "tagged";
+  int m_tlb_num_asids = 4096;
+  // Nested (guest + stage-2) translation for virtualized hosts. Guest page
+  // tables live in guest-physical space and are translated through the
+  // stage-2 table at stage2_pt_base. Nested TLB (gPA->hPA) and stage-2 PWC
+  // use the "entries:assoc:latency" format (empty = disabled)
+  bool m_nested_paging = false;
+  uint64_t m_stage2_pt_base = STAGE2_PAGE_TABLE_BASE;
+  std::string m_nested_tlb_config;
+  std::string m_stage2_pwc_config;
+  // Host-initiated TLB shootdowns over the CXL BI path. The trace has
+  // "<ndp cycle> <va> [pages] [asid]" lines; without a trace, interval > 0
+  // invalidates tlb_inval_pages random launched pages every interval cycles
+  std::string m_tlb_inval_trace;
+  int m_tlb_inval_interval = 0;
+  int m_tlb_inval_pages = 1;
+  // Translate each distinct 4KB page of a vector memory request once in the
+  // DTLB and hand the result to the other requests on that page
+  bool m_tlb_vector_batch = false;
+  // Functional memory backend for input/output memory maps: "hash" keeps one
+  // hash entry per 32B line, "flat" uses lazily allocated flat pages
+  std::string m_memory_map_backend = "hash";
+  uint64_t m_memory_map_page_size = 2 * 1024 * 1024;
+  // Number of mismatched lines (lowest addresses first) printed when the
+  // functional result check fails
+  int m_match_report_limit = 16;
+  // Snapshot the input memory map (with the built page table) once and
+  // restore it before every kernel launch after the first, so each kernel
+  // runs on the loaded input instead of the previous kernel's output
+  bool m_memory_map_restore = false;
   // Spad configuration
   int m_spad_latency = 1;
 
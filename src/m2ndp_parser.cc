@@ -638,6 +638,16 @@ KernelLaunchInfo* M2NDPParser::parse_kernel_launch(std::string line, int host_id
     info->float_args[i] = float_arg;
   }
   info->num_float_args = num_fp32_args;
+  /* Optional address space of the launch: "PT_BASE <hex>" and "ASID <hex>" */
+  std::string key;
+  while (ss >> key) {
+    if (key == "PT_BASE")
+      ss >> std::hex >> info->pt_base;
+    else if (key == "ASID")
+      ss >> std::hex >> info->asid;
+    else
+      spdlog::warn("Unknown kernel launch field: {}", key);
+  }
 
   /* Sanity check for number of kernel argument */
   assert(num_int_args <= MAX_NR_INT_ARG);
@@ -652,6 +662,8 @@ KernelLaunchInfo* M2NDPParser::parse_kernel_launch(std::string line, int host_id
   for (int i = 0; i < info->num_float_args; i++) {
     spdlog::info("float_args[{}]: {}", i, info->float_args[i]);
   }
+  if (info->pt_base != PAGE_TABLE_BASE || info->asid >= 0)
+    spdlog::info("pt_base: 0x{:x} asid: {}", info->pt_base, info->asid);
   
   return info;
 }
@@ -757,6 +769,115 @@ void M2NDPParser::parse_to_const(M2NDPConfig *config, std::string config_dir,
     config->m_itlb_config = value;
   else if (name == "tlb_hit_latency")
     config->m_tlb_hit_latency = atoi(value.c_str());
+  else if (name == "stlb_config")
+    config->m_stlb_config = value;
+  else if (name == "stlb_hit_latency")
+    config->m_stlb_hit_latency = atoi(value.c_str());
+  else if (name == "num_page_walkers")
+    config->m_num_page_walkers = atoi(value.c_str());
+  else if (name == "page_walk_queue_size")
+    config->m_page_walk_queue_size = atoi(value.c_str());
+  else if (name == "ptw_issue_rate")
+    config->m_ptw_issue_rate = atoi(value.c_str());
+  else if (name == "enable_demand_paging")
+    config->m_enable_demand_paging = atoi(value.c_str());
+  else if (name == "page_fault_latency")
+    config->m_page_fault_latency = atoi(value.c_str());
+  else if (name == "enable_ats")
+    config->m_enable_ats = atoi(value.c_str());
+  else if (name == "atc_config")
+    config->m_atc_config = value;
+  else if (name == "atc_hit_latency")
+    config->m_atc_hit_latency = atoi(value.c_str());
+  else if (name == "iommu_iotlb_config")
+    config->m_iommu_iotlb_config = value;
+  else if (name == "iommu_iotlb_hit_latency")
+    config->m_iommu_iotlb_hit_latency = atoi(value.c_str());
+  else if (name == "iommu_walk_latency")
+    config->m_iommu_walk_latency = atoi(value.c_str());
+  else if (name == "shared_tlb_config")
+    config->m_shared_tlb_config = value;
+  else if (name == "shared_tlb_banks")
+    config->m_shared_tlb_banks = atoi(value.c_str());
+  else if (name == "shared_tlb_ports")
+    config->m_shared_tlb_ports = atoi(value.c_str());
+  else if (name == "shared_tlb_hit_latency")
+    config->m_shared_tlb_hit_latency = atoi(value.c_str());
+  else if (name == "shared_tlb_xbar_latency")
+    config->m_shared_tlb_xbar_latency = atoi(value.c_str());
+  else if (name == "tlb_coalesce_pages")
+    config->m_tlb_coalesce_pages = atoi(value.c_str());
+  else if (name == "tlb_prefetch_degree")
+    config->m_tlb_prefetch_degree = atoi(value.c_str());
+  else if (name == "tlb_prefetch_buffer_entries")
+    config->m_tlb_prefetch_buffer_entries = atoi(value.c_str());
+  else if (name == "tlb_prefetch_throttle") {
+    config->m_tlb_prefetch_throttle = atoi(value.c_str());
+    if (config->m_tlb_prefetch_throttle < 1 ||
+        config->m_tlb_prefetch_throttle > 100) {
+      spdlog::error("tlb_prefetch_throttle must be in [1, 100] (got {})",
+                    value);
+      exit(1);
+    }
+  }
+  else if (name == "pte_ad_update")
+    config->m_pte_ad_update = atoi(value.c_str());
+  else if (name == "uthread_tlb_aware")
+    config->m_uthread_tlb_aware = atoi(value.c_str());
+  else if (name == "uthread_tlb_window")
+    config->m_uthread_tlb_window = atoi(value.c_str());
+  else if (name == "build_page_table")
+    config->m_build_page_table = atoi(value.c_str());
+  else if (name == "page_table_policy")
+    config->m_page_table_policy = value;
+  else if (name == "page_table_page_size")
+    config->m_page_table_page_size = std::stoull(value);
+  else if (name == "page_table_frame_base") {
+    std::stringstream ss(value);
+    ss >> std::hex >> config->m_page_table_frame_base;
+  } else if (name == "page_table_colors")
+    config->m_page_table_colors = atoi(value.c_str());
+  else if (name == "page_table_seed")
+    config->m_page_table_seed = atoi(value.c_str());
+  else if (name == "page_table_placement")
+    config->m_page_table_placement = value;
+  else if (name == "page_table_replicas")
+    config->m_page_table_replicas = atoi(value.c_str());
+  else if (name == "tlb_asid_mode")
+    config->m_tlb_asid_mode = value;
+  else if (name == "tlb_num_asids")
+    config->m_tlb_num_asids = atoi(value.c_str());
+  else if (name == "nested_paging")
+    config->m_nested_paging = atoi(value.c_str());
+  else if (name == "stage2_pt_base") {
+    std::stringstream ss(value);
+    ss >> std::hex >> config->m_stage2_pt_base;
+  } else if (name == "nested_tlb_config")
+    config->m_nested_tlb_config = value;
+  else if (name == "stage2_pwc_config")
+    config->m_stage2_pwc_config = value;
+  else if (name == "tlb_inval_trace")
+    config->m_tlb_inval_trace = value;
+  else if (name == "tlb_inval_interval")
+    config->m_tlb_inval_interval = atoi(value.c_str());
+  else if (name == "tlb_inval_pages")
+    config->m_tlb_inval_pages = atoi(value.c_str());
+  else if (name == "tlb_vector_batch")
+    config->m_tlb_vector_batch = atoi(value.c_str());
+  else if (name == "memory_map_backend")
+    config->m_memory_map_backend = value;
+  else if (name == "memory_map_page_size")
+    config->m_memory_map_page_size = std::stoull(value);
+  else if (name == "match_report_limit")
+    config->m_match_report_limit = atoi(value.c_str());
+  else if (name == "memory_map_restore")
+    config->m_memory_map_restore = atoi(value.c_str());
+  else if (name == "pml4e_cache_config")
+    config->m_pml4e_cache_config = value;
+  else if (name == "pdpte_cache_config")
+    config->m_pdpte_cache_config = value;
+  else if (name == "pde_cache_config")
+    config->m_pde_cache_config = value;
   else if (name == "max_kernel_register") 
     config->m_max_kernel_register = atoi(value.c_str());
   else if (name == "max_kernel_launch") 
@@ -130,8 +130,22 @@ class mem_fetch {
     m_mem_access_type = GLOBAL_ACC_W;
     return m_bi_writeback; 
   }
+  // MMU가 host로 보내는 page fault (reply가 돌아오면 walk replay)
+  void set_page_fault() { m_page_fault = true; }
+  bool is_page_fault() { return m_page_fault; }
+  // ATS translation request (ATS 모드에서 TLB miss를 host IOMMU로)
+  void set_ats_request() { m_ats_request = true; }
+  bool is_ats_request() { return m_ats_request; }
+  // host가 처리하는 변환 메시지 (BI처럼 host로 라우팅)
+  bool is_host_translation() { return m_page_fault || m_ats_request; }
+  // host → device TLB shootdown (data = TlbInvalInfo, reply가 ack)
+  void set_tlb_invalidate() { m_tlb_invalidate = true; }
+  bool is_tlb_invalidate() { return m_tlb_invalidate; }
   bool is_uthread_request() { return m_uthread_request; }
   void set_uthread_request() { m_uthread_request = true; }
+  // 변환에 쓸 address space (kernel launch의 ASID)
+  void set_asid(int asid) { m_asid = asid; }
+  int get_asid() { return m_asid; }
   bool is_sc_addr() { return m_sc_addr; }
   void set_sc_addr() { m_sc_addr = true; }
   std::string current_state = "NONE";
@@ -153,7 +167,7 @@ class mem_fetch {
   bool m_atomic;
   unsigned m_ndp_id;
   unsigned m_src_id;
-  unsigned m_sub_core_id;
+  unsigned m_sub_core_id = 0;
   bool m_from_dma = false;
   bool m_from_ndp = false;
   bool m_filtering = true;
@@ -167,8 +181,12 @@ class mem_fetch {
   InstColumn* m_inst_column = NULL;
   bool m_bi_request = false;
   bool m_bi_writeback = false;
+  bool m_page_fault = false;
+  bool m_ats_request = false;
+  bool m_tlb_invalidate = false;
   bool m_uthread_request = false;
   bool m_sc_addr = false;
+  int m_asid = 0;
 
 };
 }
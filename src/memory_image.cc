@@ -0,0 +1,218 @@
+#include "memory_image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "memory_map.h"
+
+namespace NDPSim {
+
+static uint64_t align_up(uint64_t value, uint64_t align) {
+  return (value + align - 1) / align * align;
+}
+
+bool IsMemoryImage(const std::string& path) {
+  std::ifstream ifs(path, std::ios::binary);
+  char magic[sizeof(MEMORY_IMAGE_MAGIC)];
+  if (!ifs.read(magic, sizeof(magic))) return false;
+  return memcmp(magic, MEMORY_IMAGE_MAGIC, sizeof(magic)) == 0;
+}
+
+void FlatMemoryMap::SaveImage(const std::string& path) const {
+  static_assert(sizeof(LineMeta) == 3, "image stores 3B line meta");
+  if (m_page_size < MEMORY_IMAGE_ALIGN) {
+    spdlog::error("Memory image: page size {} is smaller than {}", m_page_size,
+                  MEMORY_IMAGE_ALIGN);
+    exit(1);
+  }
+  uint64_t lines = m_page_size / PACKET_SIZE;
+  std::vector<uint64_t> page_nums;
+  page_nums.reserve(m_pages.size());
+  for (auto& [page_num, page] : m_pages) page_nums.push_back(page_num);
+  std::sort(page_nums.begin(), page_nums.end());
+
+  // 연속된 페이지를 range 하나로
+  std::vector<MemoryImageRange> ranges;
+  std::vector<size_t> range_first;  // range의 첫 페이지 (page_nums 인덱스)
+  for (size_t i = 0; i < page_nums.size(); i++) {
+    if (i == 0 || page_nums[i] != page_nums[i - 1] + 1) {
+      MemoryImageRange range{};
+      range.base = page_nums[i] << m_page_shift;
+      ranges.push_back(range);
+      range_first.push_back(i);
+    }
+    MemoryImageRange& range = ranges.back();
+    range.size += m_page_size;
+    const LineMeta* meta = m_pages.at(page_nums[i])->meta;
+    for (uint64_t l = 0; l < lines; l++) {
+      if (meta[l].type == EMPTY_LINE) continue;
+      range.num_lines++;
+      if (range.num_lines == 1)
+        range.dtype = meta[l].type;
+      else if (range.dtype != meta[l].type)
+        range.dtype = MEMORY_IMAGE_MIXED_TYPE;
+    }
+  }
+
+  MemoryImageHeader header{};
+  memcpy(header.magic, MEMORY_IMAGE_MAGIC, sizeof(header.magic));
+  header.version = MEMORY_IMAGE_VERSION;
+  header.line_size = PACKET_SIZE;
+  header.page_size = m_page_size;
+  header.num_ranges = ranges.size();
+  header.range_offset = sizeof(MemoryImageHeader);
+  header.num_lines = m_num_lines;
+  uint64_t offset = align_up(
+      header.range_offset + ranges.size() * sizeof(MemoryImageRange),
+      MEMORY_IMAGE_ALIGN);
+  for (MemoryImageRange& range : ranges) {
+    range.data_offset = offset;
+    range.meta_offset = align_up(offset + range.size, MEMORY_IMAGE_ALIGN);
+    offset = align_up(range.meta_offset + range.size / PACKET_SIZE *
+                                              sizeof(LineMeta),
+                      MEMORY_IMAGE_ALIGN);
+  }
+
+  std::ofstream ofs(path, std::ios::binary);
+  if (!ofs.good()) {
+    spdlog::error("Cannot open {}", path);
+    exit(1);
+  }
+  auto pad_to = [&](uint64_t pos) {
+    static const char zeros[MEMORY_IMAGE_ALIGN] = {};
+    uint64_t cur = ofs.tellp();
+    assert(cur <= pos);
+    while (cur < pos) {
+      uint64_t n = std::min<uint64_t>(pos - cur, sizeof(zeros));
+      ofs.write(zeros, n);
+      cur += n;
+    }
+  };
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  ofs.write(reinterpret_cast<const char*>(ranges.data()),
+            ranges.size() * sizeof(MemoryImageRange));
+  std::vector<uint8_t> buf(m_page_size);
+  for (size_t r = 0; r < ranges.size(); r++) {
+    const MemoryImageRange& range = ranges[r];
+    uint64_t num_pages = range.size / m_page_size;
+    pad_to(range.data_offset);
+    for (uint64_t p = 0; p < num_pages; p++) {
+      const Page* page = m_pages.at(page_nums[range_first[r] + p]).get();
+      // 빈 라인은 초기화되지 않은 값이므로 0으로
+      for (uint64_t l = 0; l < lines; l++) {
+        uint8_t* dst = buf.data() + l * PACKET_SIZE;
+        if (page->meta[l].type == EMPTY_LINE)
+          memset(dst, 0, PACKET_SIZE);
+        else
+          memcpy(dst, page->data + l * PACKET_SIZE, PACKET_SIZE);
+      }
+      ofs.write(reinterpret_cast<const char*>(buf.data()), m_page_size);
+    }
+    pad_to(range.meta_offset);
+    for (uint64_t p = 0; p < num_pages; p++) {
+      const Page* page = m_pages.at(page_nums[range_first[r] + p]).get();
+      ofs.write(reinterpret_cast<const char*>(page->meta),
+                lines * sizeof(LineMeta));
+    }
+  }
+  pad_to(offset);
+  if (!ofs.good()) {
+    spdlog::error("Memory image: write to {} failed", path);
+    exit(1);
+  }
+}
+
+void FlatMemoryMap::MapImage(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    spdlog::error("Memory image not found: {}", path);
+    exit(1);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    spdlog::error("Memory image: fstat {} failed", path);
+    exit(1);
+  }
+  uint64_t file_size = st.st_size;
+  if (file_size < sizeof(MemoryImageHeader)) {
+    spdlog::error("Memory image {} is truncated", path);
+    exit(1);
+  }
+  // 읽기 전용 파일을 private 매핑: Store는 해당 OS 페이지만 복사해서 씀
+  void* addr = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    spdlog::error("Memory image: mmap {} failed", path);
+    exit(1);
+  }
+  Reset();
+  m_image.reset(addr, [file_size](void* p) { munmap(p, file_size); });
+  uint8_t* base = static_cast<uint8_t*>(addr);
+
+  const MemoryImageHeader* header =
+      reinterpret_cast<const MemoryImageHeader*>(base);
+  if (memcmp(header->magic, MEMORY_IMAGE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != MEMORY_IMAGE_VERSION) {
+    spdlog::error("Memory image {}: bad magic or version {}", path,
+                  header->version);
+    exit(1);
+  }
+  if (header->line_size != PACKET_SIZE ||
+      header->page_size < MEMORY_IMAGE_ALIGN ||
+      (header->page_size & (header->page_size - 1))) {
+    spdlog::error("Memory image {}: line size {} / page size {} unsupported",
+                  path, header->line_size, header->page_size);
+    exit(1);
+  }
+  m_page_size = header->page_size;
+  m_page_shift = __builtin_ctzll(m_page_size);
+  uint64_t lines = m_page_size / PACKET_SIZE;
+  // [offset, offset + len)이 파일 안인지 (overflow 없이), 밖을 읽으면 SIGBUS
+  auto in_file = [file_size](uint64_t offset, uint64_t len) {
+    return offset <= file_size && len <= file_size - offset;
+  };
+  if (header->num_ranges > file_size / sizeof(MemoryImageRange) ||
+      !in_file(header->range_offset,
+               header->num_ranges * sizeof(MemoryImageRange))) {
+    spdlog::error("Memory image {}: range table ({} ranges) is out of file",
+                  path, header->num_ranges);
+    exit(1);
+  }
+  const MemoryImageRange* ranges =
+      reinterpret_cast<const MemoryImageRange*>(base + header->range_offset);
+  for (uint64_t r = 0; r < header->num_ranges; r++) {
+    const MemoryImageRange& range = ranges[r];
+    if ((range.base | range.size) & (m_page_size - 1)) {
+      spdlog::error("Memory image {}: range {:#x} is not page aligned", path,
+                    range.base);
+      exit(1);
+    }
+    if (!in_file(range.data_offset, range.size) ||
+        !in_file(range.meta_offset,
+                 range.size / PACKET_SIZE * sizeof(LineMeta))) {
+      spdlog::error("Memory image {}: range {:#x} is out of file", path,
+                    range.base);
+      exit(1);
+    }
+    for (uint64_t p = 0; p < range.size / m_page_size; p++) {
+      auto page = std::make_unique<Page>();
+      page->data = base + range.data_offset + p * m_page_size;
+      page->meta = reinterpret_cast<LineMeta*>(base + range.meta_offset) +
+                   p * lines;
+      m_pages[(range.base >> m_page_shift) + p] = std::move(page);
+    }
+  }
+  m_num_lines = header->num_lines;
+  spdlog::info("Memory image {} mapped: {} ranges {} lines", path,
+               header->num_ranges, m_num_lines);
+}
+
+}  // namespace NDPSim
@@ -0,0 +1,51 @@
+#ifndef MEMORY_IMAGE_H
+#define MEMORY_IMAGE_H
+
+#include <cstdint>
+#include <string>
+
+namespace NDPSim {
+
+// Binary memory image (.mimg): 텍스트 memory map(_META_/_DATA_)을 파싱하지
+// 않고 그대로 mmap해서 FlatMemoryMap 페이지로 쓰는 형식.
+//
+//   [0]             MemoryImageHeader
+//   [range_offset]  MemoryImageRange[num_ranges]
+//   [data_offset]   range마다 size 바이트 (데이터가 없는 라인은 0)
+//   [meta_offset]   range마다 라인당 3B {DataType, vlen, double_reg}
+//                   (빈 라인은 DataType 자리가 0xFF)
+//
+// range는 데이터가 있는 FlatMemoryMap 페이지가 연속된 구간이고 base/size는
+// page_size 정렬, 파일 안의 data/meta 위치는 MEMORY_IMAGE_ALIGN 정렬.
+// 값은 모두 little-endian (시뮬레이터 호스트와 같은 바이트 순서).
+static const char MEMORY_IMAGE_MAGIC[8] = {'M', '2', 'N', 'D', 'P', 'I', 'M', 'G'};
+static const uint32_t MEMORY_IMAGE_VERSION = 1;
+static const uint64_t MEMORY_IMAGE_ALIGN = 4096;
+// range 안 라인의 타입이 섞여 있을 때 MemoryImageRange::dtype
+static const uint8_t MEMORY_IMAGE_MIXED_TYPE = 0xFF;
+
+struct MemoryImageHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t line_size;  // PACKET_SIZE
+  uint64_t page_size;  // FlatMemoryMap 페이지 크기 (MEMORY_IMAGE_ALIGN 이상)
+  uint64_t num_ranges;
+  uint64_t range_offset;
+  uint64_t num_lines;  // 데이터가 있는 라인 수
+};
+
+struct MemoryImageRange {
+  uint64_t base;
+  uint64_t size;
+  uint64_t data_offset;
+  uint64_t meta_offset;
+  uint64_t num_lines;
+  uint8_t dtype;  // 모든 라인이 같은 DataType이면 그 값, 아니면 MIXED
+  uint8_t pad[7];
+};
+
+// 파일 앞의 magic으로 판단 (확장자와 무관)
+bool IsMemoryImage(const std::string& path);
+
+}  // namespace NDPSim
+#endif
@@ -1,316 +1,679 @@
 #include "memory_map.h"
 
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <queue>
 #include <sstream>
+#include <thread>
+
+#include "memory_image.h"
 
 #define EPS 0.000001f
 namespace NDPSim {
 
+MemoryMap* MemoryMap::New(const std::string& backend,
+                          const std::string& file_path, uint64_t page_size) {
+  if (IsMemoryImage(file_path)) return new FlatMemoryMap(file_path);
+  if (backend == "hash") return new HashMemoryMap(file_path);
+  if (backend == "flat") return new FlatMemoryMap(file_path, page_size);
+  spdlog::error("Unknown memory map backend: {}", backend);
+  exit(1);
+}
+
+MemoryMap* MemoryMap::Snapshot() {
+  spdlog::error("This memory map backend does not support snapshots");
+  exit(1);
+}
+
+void MemoryMap::Restore(const MemoryMap& snapshot) {
+  spdlog::error("This memory map backend does not support snapshots");
+  exit(1);
+}
+
 HashMemoryMap::HashMemoryMap(std::string file_path) {
   m_base = 0;
   m_size = UINT64_MAX;
-  std::ifstream ifs(file_path);
-  if (!ifs.good()) {
-    spdlog::error("Memory Map file not found: {}", file_path);
-    exit(1);
-  }
-  std::string line;
-  bool meta_read = false;
-  DataType meta_type;
+  ReadMemoryMapFile(file_path);
+}
 
-  int max_data_size = 0;
-  int temp_size = 0;
-  bool base_pushed = false;
+// memory map 텍스트 파서: 입력(압축이면 해제한 내용)을 줄 경계에서 끊은
+// window 단위로 읽는다. window 안에서 _META_/_DATA_ 표시만 순서대로 찾아
+// _DATA_ 구간을 나누고, 구간을 줄 경계의 조각으로 잘라 여러 스레드에서
+// std::from_chars로 파싱한다. 결과는 조각 순서대로 Store하므로 한 스레드로
+// 읽은 것과 같고, window의 텍스트와 파싱 결과는 Store 후 버리므로 메모리
+// 사용량은 파일 크기와 무관하다.
+static const uint64_t PARSE_CHUNK_BYTES = 4 * 1024 * 1024;
+static const uint64_t PARSE_WINDOW_BYTES = 16 * PARSE_CHUNK_BYTES;
 
-  std::queue<uint64_t> base_q;
+struct DataChunk {
+  const char* begin;
+  const char* end;
+  DataType type;
+};
 
-  int dbg = 0;
+struct ParsedChunk {
+  std::vector<std::pair<uint64_t, VectorData>> lines;
+  const char* bad_line = nullptr;  // 주소가 잘못된 줄 (없으면 nullptr)
+};
 
-  while (!ifs.eof()) {
-    getline(ifs, line);
-    if (line.find("_META_") != std::string::npos) {
-      meta_read = true;
-      continue;
-    }
-    if (line.find("_DATA_") != std::string::npos) {
-      temp_size = 0;
-      base_pushed = false;
-      meta_read = false;
-      continue;
-    }
-    if (line.length() == 0) {
-      continue;
+// window 사이에 이어지는 _META_ 상태
+struct ParseState {
+  bool meta_read = false;
+  DataType meta_type = MAX_DataType;
+};
+
+// memory map 텍스트 입력: 일반 파일, gzip(zlib), zstd(zstd CLI 자식 프로세스)
+class MemoryMapInput {
+ public:
+  explicit MemoryMapInput(const std::string& file_path) : m_path(file_path) {
+    m_fd = open(file_path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+      spdlog::error("Memory Map file not found: {}", file_path);
+      exit(1);
     }
-    if (meta_read) {
-      // Meta Data read
-      std::stringstream ss(line);
-      std::string tmp;
-      ss >> tmp;
-      if (tmp == "float16") {
-        meta_type = DataType::FLOAT16;
-      } else if (tmp == "float32") {
-        meta_type = DataType::FLOAT32;
-      } else if (tmp == "int16") {
-        meta_type = DataType::INT16;
-      } else if (tmp == "int32") {
-        meta_type = DataType::INT32;
-      } else if (tmp == "char8") {
-        meta_type = DataType::CHAR8;
-      } else if (tmp == "int64") {
-        meta_type = DataType::INT64;
-      } else if (tmp == "uint8") {
-        meta_type = DataType::UINT8;
-      } else if (tmp == "bool8") {
-        meta_type = DataType::BOOL;
+    unsigned char magic[4] = {};
+    ssize_t n = pread(m_fd, magic, sizeof(magic), 0);
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+      // gzip: fd는 gzFile이 닫음
+      m_gz = gzdopen(m_fd, "rb");
+      m_fd = -1;
+      if (!m_gz) {
+        spdlog::error("Memory Map file {}: cannot open gzip stream", m_path);
+        exit(1);
       }
-    } else {
-      // Data read
-      // spdlog::info(line);
-      uint64_t addr_base;
-      std::stringstream ss(line);
-      ss >> std::hex >> addr_base;
-      assert(addr_base != 0);
-      assert(addr_base % PACKET_SIZE == 0);
-      if (!base_pushed) {
-        base_q.push(addr_base);
-        base_pushed = true;
-      }
-      VectorData input_data64(64, 1);
-      VectorData input_data32(32, 1);
-      VectorData input_data16(16, 1);
-      VectorData input_data8(8, 1);
-      input_data32.SetType(meta_type);
-      input_data8.SetType(meta_type);
-
-      /* To read decimal values from memory map*/
-      ss >> std::dec;
-      for (int iter = 0; iter < PACKET_SIZE / 4; iter++) {
-        if (meta_type == DataType::FLOAT16) {
-          half fp16_0, fp16_1;
-          std::string str_fp16_0, str_fp16_1;
-          ss >> str_fp16_0 >> str_fp16_1;
-          fp16_0 = std::stof(str_fp16_0);
-          fp16_1 = std::stof(str_fp16_1);
-          input_data16.SetData(fp16_0, iter * 2);
-          input_data16.SetData(fp16_1, iter * 2 + 1);
-        } else if (meta_type == DataType::FLOAT32) {
-          float fp32;
-          ss >> fp32;
-          input_data32.SetData(fp32, iter);
-        } else if (meta_type == DataType::INT32) {
-          int32_t int32;
-          ss >> int32;
-          input_data32.SetData(int32, iter);
-        } else if (meta_type == DataType::INT64) {
-          if (iter >= (PACKET_SIZE / 8)) continue;
-          int64_t int64;
-          ss >> int64;
-          input_data64.SetData(int64, iter);
-        } else if (meta_type == DataType::CHAR8) {
-          std::string str_char8_0, str_char8_1, str_char8_2, str_char8_3;
-          ss >> str_char8_0 >> str_char8_1 >> str_char8_2 >> str_char8_3;
-          int char8_0 = std::stoi(str_char8_0);
-          int char8_1 = std::stoi(str_char8_1);
-          int char8_2 = std::stoi(str_char8_2);
-          int char8_3 = std::stoi(str_char8_3);
-          input_data8.SetData(static_cast<char>(std::stoi(str_char8_0)),
-                              iter * 4);
-          input_data8.SetData(static_cast<char>(std::stoi(str_char8_1)),
-                              iter * 4 + 1);
-          input_data8.SetData(static_cast<char>(std::stoi(str_char8_2)),
-                              iter * 4 + 2);
-          input_data8.SetData(static_cast<char>(std::stoi(str_char8_3)),
-                              iter * 4 + 3);
-        } else if (meta_type == DataType::UINT8) {
-          std::string str_char8_0, str_char8_1, str_char8_2, str_char8_3;
-          ss >> str_char8_0 >> str_char8_1 >> str_char8_2 >> str_char8_3;
-          uint8_t char8_0 = std::stoi(str_char8_0);
-          uint8_t char8_1 = std::stoi(str_char8_1);
-          uint8_t char8_2 = std::stoi(str_char8_2);
-          uint8_t char8_3 = std::stoi(str_char8_3);
-          input_data8.SetData(static_cast<uint8_t>(std::stoi(str_char8_0)),
-                              iter * 4);
-          input_data8.SetData(static_cast<uint8_t>(std::stoi(str_char8_1)),
-                              iter * 4 + 1);
-          input_data8.SetData(static_cast<uint8_t>(std::stoi(str_char8_2)),
-                              iter * 4 + 2);
-          input_data8.SetData(static_cast<uint8_t>(std::stoi(str_char8_3)),
-                              iter * 4 + 3);
-        } else if (meta_type == DataType::BOOL) {
-          std::string str_char8_0, str_char8_1, str_char8_2, str_char8_3;
-          ss >> str_char8_0 >> str_char8_1 >> str_char8_2 >> str_char8_3;
-          uint8_t char8_0 = std::stoi(str_char8_0);
-          uint8_t char8_1 = std::stoi(str_char8_1);
-          uint8_t char8_2 = std::stoi(str_char8_2);
-          uint8_t char8_3 = std::stoi(str_char8_3);
-          input_data8.SetData(static_cast<bool>(std::stoi(str_char8_0)),
-                              iter * 4);
-          input_data8.SetData(static_cast<bool>(std::stoi(str_char8_1)),
-                              iter * 4 + 1);
-          input_data8.SetData(static_cast<bool>(std::stoi(str_char8_2)),
-                              iter * 4 + 2);
-          input_data8.SetData(static_cast<bool>(std::stoi(str_char8_3)),
-                              iter * 4 + 3);
-        }
+      gzbuffer(m_gz, 1 << 20);
+    } else if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+               magic[2] == 0x2f && magic[3] == 0xfd) {
+      // zstd: 라이브러리 의존성 없이 zstd CLI로 해제 (shell 없이 argv로 실행)
+      close(m_fd);
+      int fds[2];
+      if (pipe(fds) != 0 || (m_pid = fork()) < 0) {
+        spdlog::error("Memory Map file {}: cannot start zstd", m_path);
+        exit(1);
       }
-      assert(m_data_map.find(addr_base) == m_data_map.end());
-      if (meta_type == CHAR8 || meta_type == UINT8 || meta_type == BOOL)
-        m_data_map[addr_base] = input_data8;
-      else if (meta_type == FLOAT16 || meta_type == INT16)
-        m_data_map[addr_base] = input_data16;
-      else if (meta_type == FLOAT32 || meta_type == INT32)
-        m_data_map[addr_base] = input_data32;
-      else if (meta_type == INT64)
-        m_data_map[addr_base] = input_data64;
-      else {
-        spdlog::error("Unknown data type", file_path);
+      if (m_pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execlp("zstd", "zstd", "-dc", "--", file_path.c_str(), (char*)nullptr);
+        _exit(127);
+      }
+      close(fds[1]);
+      m_fd = fds[0];
+    }
+  }
+
+  ~MemoryMapInput() {
+    if (m_gz) gzclose(m_gz);
+    if (m_fd >= 0) close(m_fd);
+  }
+
+  // 최대 size 바이트를 읽어 읽은 수 반환 (끝이면 0)
+  size_t Read(char* buf, size_t size) {
+    if (m_gz) {
+      int n = gzread(m_gz, buf, std::min<size_t>(size, 1 << 30));
+      if (n < 0) {
+        spdlog::error("Memory Map file {}: gzip stream is corrupted", m_path);
         exit(1);
       }
+      return n;
+    }
+    ssize_t n;
+    while ((n = read(m_fd, buf, size)) < 0 && errno == EINTR) {
+    }
+    if (n < 0) {
+      spdlog::error("Memory Map file {}: read failed", m_path);
+      exit(1);
+    }
+    return n;
+  }
+
+  // 끝까지 읽은 뒤 zstd 프로세스가 정상 종료했는지 확인
+  void Finish() {
+    if (m_pid <= 0) return;
+    close(m_fd);
+    m_fd = -1;
+    int status;
+    if (waitpid(m_pid, &status, 0) != m_pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+      spdlog::error("Memory Map file {}: zstd -dc failed", m_path);
+      exit(1);
     }
+    m_pid = 0;
   }
+
+ private:
+  std::string m_path;
+  int m_fd = -1;
+  gzFile m_gz = nullptr;
+  pid_t m_pid = 0;
+};
+
+static bool ParseMetaType(const std::string& token, DataType& type) {
+  if (token == "float16") type = DataType::FLOAT16;
+  else if (token == "float32") type = DataType::FLOAT32;
+  else if (token == "int16") type = DataType::INT16;
+  else if (token == "int32") type = DataType::INT32;
+  else if (token == "char8") type = DataType::CHAR8;
+  else if (token == "int64") type = DataType::INT64;
+  else if (token == "uint8") type = DataType::UINT8;
+  else if (token == "bool8") type = DataType::BOOL;
+  else return false;
+  return true;
 }
 
-bool HashMemoryMap::Match(MemoryMap& other2) {
-  HashMemoryMap& other = dynamic_cast<HashMemoryMap&>(other2);
-  bool result = true;
-  for (auto& [key, val] : m_data_map) {
-    if (other.m_data_map.find(key) == other.m_data_map.end()) {
-      spdlog::error("Key miss match Addr {:x}", key);
-      result = false;
-      break;
+static inline const char* SkipSpace(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+  return p;
+}
+
+template <typename T>
+static inline const char* ParseInt(const char* p, const char* end, T& value,
+                                   int base = 10) {
+  p = SkipSpace(p, end);
+  if (p < end && *p == '+') p++;
+  auto [ptr, ec] = std::from_chars(p, end, value, base);
+  if (ec != std::errc()) value = 0;
+  return ptr;
+}
+
+static inline const char* ParseFloat(const char* p, const char* end,
+                                     float& value) {
+  p = SkipSpace(p, end);
+#if defined(__cpp_lib_to_chars)
+  if (p < end && *p == '+') p++;
+  auto [ptr, ec] = std::from_chars(p, end, value);
+  if (ec != std::errc()) value = 0;
+  return ptr;
+#else
+  // floating-point from_chars가 없는 libstdc++ (GCC < 11)
+  char* ptr;
+  value = strtof(p, &ptr);
+  return ptr;
+#endif
+}
+
+static void ParseDataChunk(const DataChunk& chunk, ParsedChunk& out) {
+  const char* p = chunk.begin;
+  while (p < chunk.end) {
+    const char* eol =
+        static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+    if (!eol) eol = chunk.end;
+    const char* line = p;
+    p = SkipSpace(p, eol);
+    if (p == eol) {
+      p = eol + 1;
+      continue;
+    }
+    uint64_t addr_base = 0;
+    if (eol - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+    p = ParseInt(p, eol, addr_base, 16);
+    if (addr_base == 0 || addr_base % PACKET_SIZE != 0) {
+      out.bad_line = line;
+      return;
     }
-    VectorData other_val = other.m_data_map[key];
-    if (val.GetType() == FLOAT16) {
-      if (other_val.GetType() != FLOAT16) {
-        spdlog::error("Type miss match Addr {:x} Target {} : Real {}", key,
-                      (int)val.GetType(), (int)other_val.GetType());
-        result = false;
+    VectorData data;
+    switch (chunk.type) {
+      case FLOAT16: {
+        data = VectorData(16, 1);
+        for (int i = 0; i < PACKET_ENTRIES * 2; i++) {
+          float value;
+          p = ParseFloat(p, eol, value);
+          data.SetData(half(value), i);
+        }
         break;
       }
-      for (int i = 0; i < PACKET_ENTRIES * 2; i++) {
-        double ratio = (other_val.GetHalfData(i) - val.GetHalfData(i)) /
-                       (val.GetHalfData(i) + EPS);
-        if (other_val.GetHalfData(i) == val.GetHalfData(i)) {
-          ratio = 0;
-        }
-        bool check_data = ratio >= -0.01 && ratio <= 0.01;
-        result = result && check_data;
-        if (!check_data) {
-          spdlog::debug("{:x} : Data) {} Ans) {} diff : {}", key,
-                        float(other_val.GetHalfData(i)), float(val.GetHalfData(i)),
-                        float(other_val.GetHalfData(i) - val.GetHalfData(i)));
+      case INT16:
+        // 기존 파서와 같이 값은 읽지 않음
+        data = VectorData(16, 1);
+        break;
+      case FLOAT32: {
+        data = VectorData(32, 1);
+        data.SetType(FLOAT32);
+        for (int i = 0; i < PACKET_ENTRIES; i++) {
+          float value;
+          p = ParseFloat(p, eol, value);
+          data.SetData(value, i);
         }
-      }
-    } else if (val.GetType() == FLOAT32) {
-      if (other_val.GetType() != FLOAT32) {
-        spdlog::error("Type miss match Addr {:x} Target {} : Real {}", key,
-                      (int)val.GetType(), (int)other_val.GetType());
-        result = false;
         break;
       }
-      for (int i = 0; i < PACKET_ENTRIES; i++) {
-        double ratio = (other_val.GetFloatData(i) - val.GetFloatData(i)) /
-                       (val.GetFloatData(i) + EPS);
-        if (other_val.GetFloatData(i) == val.GetFloatData(i)) {
-          ratio = 0;
-        }
-        bool check_data = ratio >= -0.01 && ratio <= 0.01;
-        result = result && check_data;
-        if (!check_data) {
-          spdlog::debug("{:x} : Data) {} Ans) {} diff : {}", key,
-                        other_val.GetFloatData(i), val.GetFloatData(i),
-                        other_val.GetFloatData(i) - val.GetFloatData(i));
+      case INT32: {
+        data = VectorData(32, 1);
+        data.SetType(INT32);
+        for (int i = 0; i < PACKET_ENTRIES; i++) {
+          int32_t value;
+          p = ParseInt(p, eol, value);
+          data.SetData(value, i);
         }
-      }
-    } else if (val.GetType() == INT32) {
-      if (other_val.GetType() != INT32) {
-        spdlog::error("Type miss match Addr {:x} Target {} : Real {}", key,
-                      (int)val.GetType(), (int)other_val.GetType());
-        result = false;
         break;
       }
-      for (int i = 0; i < PACKET_ENTRIES; i++) {
-        bool check_data = other_val.GetIntData(i) == val.GetIntData(i);
-        result = result && check_data;
-
-        if (!check_data) {
-          spdlog::debug("{:x} : Data) {} Ans) {} diff : {}", key,
-                        other_val.GetIntData(i), val.GetIntData(i),
-                        other_val.GetIntData(i) - val.GetIntData(i));
+      case INT64: {
+        data = VectorData(64, 1);
+        for (int i = 0; i < PACKET_SIZE / 8; i++) {
+          int64_t value;
+          p = ParseInt(p, eol, value);
+          data.SetData(value, i);
         }
+        break;
       }
-    } else if (val.GetType() == INT64) {
-      if (other_val.GetType() != INT64) {
-        spdlog::error("Type miss match Addr {:x} Target {} : Real {}", key,
-                      (int)val.GetType(), (int)other_val.GetType());
-        result = false;
+      case CHAR8:
+      case UINT8:
+      case BOOL: {
+        data = VectorData(8, 1);
+        data.SetType(chunk.type);
+        for (int i = 0; i < PACKET_SIZE; i++) {
+          int value;
+          p = ParseInt(p, eol, value);
+          if (chunk.type == CHAR8)
+            data.SetData(static_cast<char>(value), i);
+          else if (chunk.type == UINT8)
+            data.SetData(static_cast<uint8_t>(value), i);
+          else
+            data.SetData(static_cast<bool>(value), i);
+        }
         break;
       }
-      for (int i = 0; i < PACKET_ENTRIES / 2; i++) {
-        if (val.GetLongData(i) == -1) continue;
-        bool check_data = other_val.GetLongData(i) == val.GetLongData(i);
-        result = result && check_data;
+      default:
+        out.bad_line = line;
+        return;
+    }
+    out.lines.emplace_back(addr_base, std::move(data));
+    p = eol + 1;
+  }
+}
 
-        if (!check_data) {
-          spdlog::debug("{:x} : Data) {} Ans) {} diff : {}", key,
-                     other_val.GetLongData(i), val.GetLongData(i),
-                     other_val.GetLongData(i) - val.GetLongData(i));
-        }
+// 줄 경계로 끝나는 window [buf, end) 하나를 파싱 (state는 다음 window로 이어짐)
+static void ParseWindow(const char* buf, const char* end, ParseState& state,
+                        std::vector<DataChunk>& chunks,
+                        std::vector<ParsedChunk>& parsed) {
+  // 1) _META_/_DATA_ 표시가 있는 줄 (같은 줄에 둘 다 있으면 _META_)
+  struct Marker {
+    const char* begin;
+    const char* end;
+    bool meta;
+  };
+  std::vector<Marker> markers;
+  for (bool meta : {true, false}) {
+    const char* pattern = meta ? "_META_" : "_DATA_";
+    const char* p = buf;
+    while (const char* hit = static_cast<const char*>(
+               memmem(p, end - p, pattern, strlen(pattern)))) {
+      const char* nl = static_cast<const char*>(memrchr(buf, '\n', hit - buf));
+      const char* line_end =
+          static_cast<const char*>(memchr(hit, '\n', end - hit));
+      markers.push_back({nl ? nl + 1 : buf, line_end ? line_end : end, meta});
+      p = line_end ? line_end : end;
+    }
+  }
+  std::sort(markers.begin(), markers.end(),
+            [](const Marker& a, const Marker& b) {
+              return a.begin != b.begin ? a.begin < b.begin : a.meta > b.meta;
+            });
+  markers.erase(std::unique(markers.begin(), markers.end(),
+                            [](const Marker& a, const Marker& b) {
+                              return a.begin == b.begin;
+                            }),
+                markers.end());
+
+  // 2) 표시 사이 구간: _META_ 뒤는 타입 줄, _DATA_ 뒤는 데이터 조각으로
+  auto add_region = [&](const char* begin, const char* region_end) {
+    if (begin >= region_end) return;
+    if (state.meta_read) {
+      std::istringstream ss(std::string(begin, region_end));
+      std::string line, token;
+      while (std::getline(ss, line)) {
+        std::stringstream ls(line);
+        if (ls >> token) ParseMetaType(token, state.meta_type);
       }
-    } else if (val.GetType() == VMASK) {
-      if (other_val.GetType() != UINT8 || other_val.GetType() != VMASK) {
-        spdlog::error("Type miss match Addr {:x} Target {} : Real {}", key,
-                      (int)val.GetType(), (int)other_val.GetType());
-        result = false;
-        break;
+      return;
+    }
+    while (begin < region_end) {
+      const char* split = begin + std::min<uint64_t>(PARSE_CHUNK_BYTES,
+                                                      region_end - begin);
+      if (split < region_end) {
+        const char* nl =
+            static_cast<const char*>(memchr(split, '\n', region_end - split));
+        split = nl ? nl + 1 : region_end;
       }
-    } else if (val.GetType() == UINT8) {
-      if (other_val.GetType() != UINT8) {
-        spdlog::error("Type miss match Addr {:x} Target {} : Real {}", key,
-                      (int)val.GetType(), (int)other_val.GetType());
-        result = false;
-        break;
+      chunks.push_back({begin, split, state.meta_type});
+      begin = split;
+    }
+  };
+  const char* pos = buf;
+  for (const Marker& marker : markers) {
+    add_region(pos, marker.begin);
+    state.meta_read = marker.meta;
+    pos = marker.end < end ? marker.end + 1 : end;
+  }
+  add_region(pos, end);
+
+  // 3) 조각 병렬 파싱
+  parsed.resize(chunks.size());
+  std::atomic<size_t> next_chunk{0};
+  auto worker = [&]() {
+    for (size_t i; (i = next_chunk++) < chunks.size();)
+      ParseDataChunk(chunks[i], parsed[i]);
+  };
+  size_t num_threads = std::min<size_t>(
+      chunks.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads) thread.join();
+}
+
+void MemoryMap::ReadMemoryMapFile(const std::string& file_path) {
+  MemoryMapInput input(file_path);
+  ParseState state;
+  std::string window;
+  uint64_t window_bytes = PARSE_WINDOW_BYTES;
+  uint64_t stored = 0, reserved = 0;
+  bool eof = false;
+  while (!eof) {
+    // 앞 window에서 남은 (줄 끝이 없는) 꼬리 뒤에 이어서 채움
+    while (!eof && window.size() < window_bytes) {
+      size_t old_size = window.size();
+      window.resize(window_bytes);
+      size_t n = input.Read(&window[old_size], window_bytes - old_size);
+      window.resize(old_size + n);
+      eof = n == 0;
+    }
+    size_t cut = window.size();
+    if (!eof) {
+      size_t nl = window.rfind('\n');
+      if (nl == std::string::npos) {
+        // window보다 긴 줄: 줄 끝이 나올 때까지 키움
+        window_bytes *= 2;
+        continue;
       }
-      for (int i = 0; i < PACKET_ENTRIES * 4; i++) {
-        bool check_data = other_val.GetU8Data(i) == val.GetU8Data(i);
-        result = result && check_data;
+      cut = nl + 1;
+    }
+    const char* buf = window.data();
+    const char* end = buf + cut;
+    std::vector<DataChunk> chunks;
+    std::vector<ParsedChunk> parsed;
+    ParseWindow(buf, end, state, chunks, parsed);
 
-        if (!check_data) {
-          spdlog::debug("{:x} : Data) {:b} Ans) {:b} diff : {}", key,
-                        other_val.GetU8Data(i),
-                        val.GetU8Data(i),
-                        (other_val.GetU8Data(i) - val.GetU8Data(i)));
-        }
+    // 4) 파일 순서대로 merge
+    uint64_t window_lines = 0;
+    for (size_t i = 0; i < parsed.size(); i++) {
+      if (parsed[i].bad_line) {
+        const char* line = parsed[i].bad_line;
+        const char* line_end =
+            static_cast<const char*>(memchr(line, '\n', end - line));
+        std::string text_line(line, line_end ? line_end : end);
+        if (chunks[i].type == MAX_DataType || chunks[i].type == VMASK)
+          spdlog::error("Unknown data type {}: {}", file_path, text_line);
+        else
+          spdlog::error("Invalid line address {}: {}", file_path, text_line);
+        exit(1);
       }
-    } else if (val.GetType() == BOOL) {
-      if (other_val.GetType() != BOOL) {
-        spdlog::error("Type miss match Addr {:x} Target {} : Real {}", key,
-                      (int)val.GetType(), (int)other_val.GetType());
-        result = false;
-        break;
+      window_lines += parsed[i].lines.size();
+    }
+    // 라인 수를 미리 모르므로 확보량을 두 배씩 늘림
+    if (stored + window_lines > reserved) {
+      uint64_t target = std::max(stored + window_lines, 2 * reserved);
+      ReserveLines(target - stored);
+      reserved = target;
+    }
+    for (ParsedChunk& chunk : parsed) {
+      for (auto& [addr, data] : chunk.lines) {
+        assert(!CheckAddr(addr));
+        Store(addr, std::move(data));
       }
-      for (int i = 0; i < PACKET_ENTRIES * 4; i++) {
-        bool check_data = other_val.GetBoolData(i) == val.GetBoolData(i);
-        result = result && check_data;
+      chunk.lines = {};
+    }
+    stored += window_lines;
+    window.erase(0, cut);
+  }
+  input.Finish();
+}
 
-        if (!check_data) {
-          spdlog::debug("{:x} : Data) {} Ans) {} diff : {}", key,
-                         (other_val.GetBoolData(i) ? "True" : "False"),
-                         (val.GetBoolData(i) ? "True" : "False"),
-                         other_val.GetBoolData(i) - val.GetBoolData(i));
-        }
-      }
+// 스레드 하나가 모은 불일치: 총 개수와 주소가 작은 limit개만 유지
+struct MismatchList {
+  uint64_t limit;
+  uint64_t count = 0;
+  uint64_t num_lines = 0;
+  std::vector<MemoryMismatch> list;
+
+  void Add(const MemoryMismatch& mismatch) {
+    count++;
+    if (limit == 0) return;
+    list.push_back(mismatch);
+    if (list.size() >= 2 * limit) Trim();
+  }
+  void Trim() {
+    std::sort(list.begin(), list.end(),
+              [](const MemoryMismatch& a, const MemoryMismatch& b) {
+                return a.addr < b.addr;
+              });
+    if (list.size() > limit) list.erase(list.begin() + limit, list.end());
+  }
+  void Merge(const MismatchList& other) {
+    count += other.count;
+    num_lines += other.num_lines;
+    list.insert(list.end(), other.list.begin(), other.list.end());
+    Trim();
+  }
+};
+
+// item [0, num_items)를 스레드들이 나눠서 fn(item, list)로 비교
+// (worker에서 던진 예외는 join 후 다시 던짐)
+template <typename Fn>
+static MismatchList ParallelMatch(uint64_t num_items, uint64_t limit, Fn fn) {
+  unsigned num_threads = std::max<uint64_t>(
+      1, std::min<uint64_t>(num_items, std::thread::hardware_concurrency()));
+  std::vector<MismatchList> lists(num_threads, MismatchList{limit});
+  std::vector<std::exception_ptr> errors(num_threads);
+  std::atomic<uint64_t> next_item{0};
+  auto worker = [&](unsigned tid) {
+    try {
+      for (uint64_t i; (i = next_item++) < num_items;) fn(i, lists[tid]);
+    } catch (...) {
+      errors[tid] = std::current_exception();
+      next_item = num_items;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < num_threads; t++) threads.emplace_back(worker, t);
+  worker(0);
+  for (std::thread& thread : threads) thread.join();
+  for (std::exception_ptr& error : errors)
+    if (error) std::rethrow_exception(error);
+  MismatchList result{limit};
+  for (MismatchList& list : lists) result.Merge(list);
+  return result;
+}
+
+static const char* DataTypeName(int type) {
+  static const char* names[] = {"float16", "float32", "int16", "int32",
+                                "int64",   "uint8",   "char8", "bool8",
+                                "vmask"};
+  if (type >= 0 && type < MAX_DataType) return names[type];
+  return "none";
+}
+
+static std::string ElementString(const VectorData& data, int index) {
+  switch (data.GetType()) {
+    case FLOAT16:
+      return fmt::format("{}", float(data.GetHalfData(index)));
+    case FLOAT32:
+      return fmt::format("{}", data.GetFloatData(index));
+    case INT32:
+      return fmt::format("{}", data.GetIntData(index));
+    case INT64:
+      return fmt::format("{}", data.GetLongData(index));
+    case UINT8:
+      return fmt::format("{:#b}", data.GetU8Data(index));
+    case BOOL:
+      return data.GetBoolData(index) ? "True" : "False";
+    default:
+      return "-";
+  }
+}
+
+bool MemoryMap::CompareLine(uint64_t key, const VectorData& val,
+                            const VectorData& other_val,
+                            MemoryMismatch& mismatch) {
+  DataType type = val.GetType();
+  DataType other_type = other_val.GetType();
+  mismatch.addr = key;
+  mismatch.type = type;
+  mismatch.other_type = other_type;
+  mismatch.index = 0;
+  bool type_match = type == other_type;
+  if (type == VMASK) type_match = other_type == UINT8 || other_type == VMASK;
+  if (!type_match && (type == FLOAT16 || type == FLOAT32 || type == INT32 ||
+                      type == INT64 || type == VMASK || type == UINT8 ||
+                      type == BOOL)) {
+    mismatch.kind = MemoryMismatch::TYPE;
+    return false;
+  }
+  mismatch.kind = MemoryMismatch::VALUE;
+  // float은 상대 오차 1%까지 허용 (같은 값이면 0으로)
+  auto close = [](double data, double ans) {
+    if (data == ans) return true;
+    double ratio = (data - ans) / (ans + EPS);
+    return ratio >= -0.01 && ratio <= 0.01;
+  };
+  int num_entries = 0;
+  switch (type) {
+    case FLOAT16:
+      num_entries = PACKET_ENTRIES * 2;
+      break;
+    case FLOAT32:
+    case INT32:
+      num_entries = PACKET_ENTRIES;
+      break;
+    case INT64:
+      num_entries = PACKET_ENTRIES / 2;
+      break;
+    case UINT8:
+    case BOOL:
+      num_entries = PACKET_ENTRIES * 4;
+      break;
+    default:
+      // VMASK 등은 타입만 확인
+      break;
+  }
+  for (int i = 0; i < num_entries; i++) {
+    bool check_data = true;
+    if (type == FLOAT16)
+      check_data = close(float(other_val.GetHalfData(i)),
+                         float(val.GetHalfData(i)));
+    else if (type == FLOAT32)
+      check_data = close(other_val.GetFloatData(i), val.GetFloatData(i));
+    else if (type == INT32)
+      check_data = other_val.GetIntData(i) == val.GetIntData(i);
+    else if (type == INT64)
+      // 정답의 -1은 비교하지 않음
+      check_data = val.GetLongData(i) == -1 ||
+                   other_val.GetLongData(i) == val.GetLongData(i);
+    else if (type == UINT8)
+      check_data = other_val.GetU8Data(i) == val.GetU8Data(i);
+    else if (type == BOOL)
+      check_data = other_val.GetBoolData(i) == val.GetBoolData(i);
+    if (!check_data) {
+      mismatch.index = i;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MemoryMap::ReportMatch(MemoryMap& other, uint64_t num_lines,
+                            uint64_t num_mismatches,
+                            const std::vector<MemoryMismatch>& mismatches) {
+  if (num_mismatches == 0) return true;
+  spdlog::error("Memory map mismatch: {} of {} lines (first {} by address)",
+                num_mismatches, num_lines, mismatches.size());
+  for (const MemoryMismatch& mismatch : mismatches) {
+    if (mismatch.kind == MemoryMismatch::MISSING) {
+      spdlog::error("Key miss match Addr {:x} ({})", mismatch.addr,
+                    DataTypeName(mismatch.type));
+    } else if (mismatch.kind == MemoryMismatch::TYPE) {
+      spdlog::error("Type miss match Addr {:x} Target {} : Real {}",
+                    mismatch.addr, DataTypeName(mismatch.type),
+                    DataTypeName(mismatch.other_type));
+    } else {
+      VectorData val, other_val;
+      val.LoadLine(mismatch.line, mismatch.type, PACKET_ENTRIES);
+      other_val.LoadLine(mismatch.other_line, mismatch.other_type,
+                         PACKET_ENTRIES);
+      spdlog::error("Value miss match Addr {:x} ({}) [{}] : Data) {} Ans) {}",
+                    mismatch.addr, DataTypeName(mismatch.type),
+                    mismatch.index, ElementString(other_val, mismatch.index),
+                    ElementString(val, mismatch.index));
     }
   }
-  if (!result) {
+  // 전체 덤프는 trace 레벨에서만 (큰 map에서는 문자열 변환만으로도 느림)
+  if (spdlog::should_log(spdlog::level::trace)) {
     spdlog::trace("This Memory map");
     DumpMemory();
     spdlog::trace("Target Memory Map");
     other.DumpMemory();
   }
-  return result;
+  return false;
+}
+
+// 라인 비교 후 어긋나면 두 라인을 복사해서 기록
+static void CompareAndAdd(uint64_t key, const VectorData& val,
+                          const VectorData& other_val, MismatchList& list) {
+  MemoryMismatch mismatch;
+  if (MemoryMap::CompareLine(key, val, other_val, mismatch)) return;
+  val.CopyLine(mismatch.line);
+  other_val.CopyLine(mismatch.other_line);
+  list.Add(mismatch);
+}
+
+bool HashMemoryMap::Match(MemoryMap& other) {
+  MismatchList result{(uint64_t)m_match_report_limit};
+  HashMemoryMap* other_hash = dynamic_cast<HashMemoryMap*>(&other);
+  if (other_hash && !other_hash->m_use_synthetic_memory) {
+    // 두 hash map의 find는 읽기만 하므로 주소 목록을 나눠서 병렬 비교
+    static const uint64_t BLOCK = 4096;
+    std::vector<uint64_t> addrs = GetAddrs();
+    result = ParallelMatch(
+        (addrs.size() + BLOCK - 1) / BLOCK, m_match_report_limit,
+        [&](uint64_t block, MismatchList& list) {
+          uint64_t end = std::min<uint64_t>(addrs.size(), (block + 1) * BLOCK);
+          for (uint64_t i = block * BLOCK; i < end; i++) {
+            const VectorData& val = m_data_map.find(addrs[i])->second;
+            auto it = other_hash->m_data_map.find(addrs[i]);
+            list.num_lines++;
+            if (it == other_hash->m_data_map.end()) {
+              list.Add({MemoryMismatch::MISSING, addrs[i], val.GetType(),
+                        MAX_DataType});
+              continue;
+            }
+            CompareAndAdd(addrs[i], val, it->second, list);
+          }
+        });
+  } else {
+    // 다른 backend와는 TryLoad로 (lookup 캐시가 있을 수 있어 한 스레드로)
+    VectorData other_val;
+    for (auto& [key, val] : m_data_map) {
+      result.num_lines++;
+      if (!other.TryLoad(key, other_val)) {
+        result.Add({MemoryMismatch::MISSING, key, val.GetType(), MAX_DataType});
+        continue;
+      }
+      CompareAndAdd(key, val, other_val, result);
+    }
+    result.Trim();
+  }
+  return ReportMatch(other, result.num_lines, result.count, result.list);
 }
 
 VectorData HashMemoryMap::Load(uint64_t addr) {
@@ -346,10 +709,39 @@ bool HashMemoryMap::CheckAddr(uint64_t addr) {
   return true;
 }
 
+bool HashMemoryMap::TryLoad(uint64_t addr, VectorData& out) {
+  if (m_use_synthetic_memory) return MemoryMap::TryLoad(addr, out);
+  // hash lookup 한 번으로 확인과 로드를 같이 함
+  auto it = m_data_map.find(addr);
+  if (it == m_data_map.end()) return false;
+  if (it->second.GetDoubleReg())
+    throw std::runtime_error("HashMemoryMap::Double reg Stored!");
+  out = it->second;
+  return true;
+}
+
 void HashMemoryMap::Reset() {
   m_data_map.clear();
 }
 
+MemoryMap* HashMemoryMap::Snapshot() { return new HashMemoryMap(*this); }
+
+void HashMemoryMap::Restore(const MemoryMap& snapshot) {
+  const HashMemoryMap* hash = dynamic_cast<const HashMemoryMap*>(&snapshot);
+  if (!hash) {
+    spdlog::error("HashMemoryMap::Restore: snapshot is not a HashMemoryMap");
+    exit(1);
+  }
+  m_data_map = hash->m_data_map;
+}
+
+std::vector<uint64_t> HashMemoryMap::GetAddrs() const {
+  std::vector<uint64_t> addrs;
+  addrs.reserve(m_data_map.size());
+  for (auto& [key, val] : m_data_map) addrs.push_back(key);
+  return addrs;
+}
+
 void HashMemoryMap::DumpMemory() {
   std::map<uint64_t, VectorData> dump_map;
   for (auto& [key, val] : m_data_map) {
@@ -361,6 +753,272 @@ void HashMemoryMap::DumpMemory() {
   }
 }
 
+FlatMemoryMap::FlatMemoryMap(uint64_t page_size) : m_page_size(page_size) {
+  if (page_size < PACKET_SIZE || (page_size & (page_size - 1))) {
+    spdlog::error("FlatMemoryMap: page size {} must be a power of two >= {}",
+                  page_size, PACKET_SIZE);
+    exit(1);
+  }
+  m_page_shift = __builtin_ctzll(page_size);
+}
+
+FlatMemoryMap::FlatMemoryMap(std::string file_path, uint64_t page_size)
+    : FlatMemoryMap(page_size) {
+  if (IsMemoryImage(file_path))
+    MapImage(file_path);
+  else
+    ReadMemoryMapFile(file_path);
+}
+
+FlatMemoryMap::Page* FlatMemoryMap::FindPage(uint64_t addr) {
+  uint64_t page_num = addr >> m_page_shift;
+  if (page_num == m_last_page_num) return m_last_page;
+  auto it = m_pages.find(page_num);
+  if (it == m_pages.end()) return nullptr;
+  m_last_page_num = page_num;
+  m_last_page = it->second.get();
+  m_last_page_private = it->second.use_count() == 1;
+  return m_last_page;
+}
+
+FlatMemoryMap::Page* FlatMemoryMap::GetOrAllocPage(uint64_t addr) {
+  uint64_t page_num = addr >> m_page_shift;
+  if (page_num == m_last_page_num && m_last_page_private) return m_last_page;
+  auto it = m_pages.find(page_num);
+  if (it != m_pages.end()) {
+    // 공유 중인 페이지는 복사해서 이 map만 쓰도록
+    if (it->second.use_count() > 1) it->second = ClonePage(*it->second);
+    m_last_page_num = page_num;
+    m_last_page = it->second.get();
+    m_last_page_private = true;
+    return m_last_page;
+  }
+  uint64_t lines = m_page_size / PACKET_SIZE;
+  auto page = std::make_shared<Page>();
+  // 데이터는 Store한 라인만 쓰므로 초기화하지 않음
+  page->own_data.reset(new uint8_t[m_page_size]);
+  page->own_meta.reset(new LineMeta[lines]);
+  page->data = page->own_data.get();
+  page->meta = page->own_meta.get();
+  for (uint64_t i = 0; i < lines; i++)
+    page->meta[i] = LineMeta{EMPTY_LINE, 0, false};
+  m_last_page_num = page_num;
+  m_last_page = page.get();
+  m_last_page_private = true;
+  m_pages[page_num] = std::move(page);
+  return m_last_page;
+}
+
+std::shared_ptr<FlatMemoryMap::Page> FlatMemoryMap::ClonePage(
+    const Page& page) const {
+  uint64_t lines = m_page_size / PACKET_SIZE;
+  auto clone = std::make_shared<Page>();
+  clone->own_data.reset(new uint8_t[m_page_size]);
+  clone->own_meta.reset(new LineMeta[lines]);
+  clone->data = clone->own_data.get();
+  clone->meta = clone->own_meta.get();
+  memcpy(clone->meta, page.meta, lines * sizeof(LineMeta));
+  // 데이터가 있는 라인만 복사 (나머지는 초기화되지 않은 영역)
+  for (uint64_t l = 0; l < lines; l++) {
+    if (page.meta[l].type == EMPTY_LINE) continue;
+    uint64_t end = l;
+    while (end < lines && page.meta[end].type != EMPTY_LINE) end++;
+    memcpy(clone->data + l * PACKET_SIZE, page.data + l * PACKET_SIZE,
+           (end - l) * PACKET_SIZE);
+    l = end - 1;
+  }
+  return clone;
+}
+
+MemoryMap* FlatMemoryMap::Snapshot() {
+  FlatMemoryMap* snapshot = new FlatMemoryMap(*this);
+  m_last_page_private = false;
+  snapshot->m_last_page_private = false;
+  return snapshot;
+}
+
+void FlatMemoryMap::Restore(const MemoryMap& snapshot) {
+  const FlatMemoryMap* flat = dynamic_cast<const FlatMemoryMap*>(&snapshot);
+  if (!flat || flat->m_page_size != m_page_size) {
+    spdlog::error("FlatMemoryMap::Restore: snapshot is not a {}B-page "
+                  "FlatMemoryMap", m_page_size);
+    exit(1);
+  }
+  if (flat == this) return;
+  m_pages = flat->m_pages;
+  m_image = flat->m_image;
+  m_num_lines = flat->m_num_lines;
+  m_last_page_num = UINT64_MAX;
+  m_last_page = nullptr;
+  m_last_page_private = false;
+  flat->m_last_page_private = false;
+}
+
+bool FlatMemoryMap::Match(MemoryMap& other) {
+  MismatchList result{(uint64_t)m_match_report_limit};
+  FlatMemoryMap* other_flat = dynamic_cast<FlatMemoryMap*>(&other);
+  if (other_flat && other_flat->m_page_size == m_page_size &&
+      !other_flat->m_use_synthetic_memory) {
+    // 페이지 단위 병렬 비교: 타입이 같은 연속 라인을 memcmp 한 번으로 보고,
+    // 바이트가 다른 라인만 타입대로 (float은 허용 오차로) 다시 비교
+    std::vector<const Page*> pages, other_pages;
+    std::vector<uint64_t> page_nums;
+    for (auto& [page_num, page] : m_pages) {
+      auto it = other_flat->m_pages.find(page_num);
+      page_nums.push_back(page_num);
+      pages.push_back(page.get());
+      other_pages.push_back(it == other_flat->m_pages.end() ? nullptr
+                                                            : it->second.get());
+    }
+    uint64_t lines = m_page_size / PACKET_SIZE;
+    result = ParallelMatch(
+        pages.size(), m_match_report_limit,
+        [&](uint64_t p, MismatchList& list) {
+          const Page* page = pages[p];
+          const Page* other_page = other_pages[p];
+          uint64_t base = page_nums[p] << m_page_shift;
+          VectorData val, other_val;
+          auto load = [](const Page* page, uint64_t l, VectorData& data) {
+            const LineMeta& meta = page->meta[l];
+            if (meta.double_reg)
+              throw std::runtime_error("FlatMemoryMap::Double reg Stored!");
+            data.LoadLine(page->data + l * PACKET_SIZE, (DataType)meta.type,
+                          meta.vlen);
+          };
+          for (uint64_t l = 0; l < lines; l++) {
+            const LineMeta& meta = page->meta[l];
+            if (meta.type == EMPTY_LINE) continue;
+            list.num_lines++;
+            if (!other_page || other_page->meta[l].type == EMPTY_LINE) {
+              list.Add({MemoryMismatch::MISSING, base + l * PACKET_SIZE,
+                        (DataType)meta.type, MAX_DataType});
+              continue;
+            }
+            // [l, end): 양쪽 타입이 같은 연속 라인
+            uint64_t end = l;
+            while (end < lines && page->meta[end].type != EMPTY_LINE &&
+                   page->meta[end].type == other_page->meta[end].type &&
+                   !page->meta[end].double_reg &&
+                   !other_page->meta[end].double_reg)
+              end++;
+            if (end == l) {
+              load(page, l, val);
+              load(other_page, l, other_val);
+              CompareAndAdd(base + l * PACKET_SIZE, val, other_val, list);
+              continue;
+            }
+            list.num_lines += end - l - 1;
+            const uint8_t* data = page->data + l * PACKET_SIZE;
+            const uint8_t* other_data = other_page->data + l * PACKET_SIZE;
+            if (memcmp(data, other_data, (end - l) * PACKET_SIZE) != 0) {
+              for (uint64_t i = l; i < end; i++) {
+                if (memcmp(page->data + i * PACKET_SIZE,
+                           other_page->data + i * PACKET_SIZE,
+                           PACKET_SIZE) == 0)
+                  continue;
+                load(page, i, val);
+                load(other_page, i, other_val);
+                CompareAndAdd(base + i * PACKET_SIZE, val, other_val, list);
+              }
+            }
+            l = end - 1;
+          }
+        });
+  } else {
+    VectorData other_val;
+    for (uint64_t key : GetAddrs()) {
+      VectorData val = Load(key);
+      result.num_lines++;
+      if (!other.TryLoad(key, other_val)) {
+        result.Add({MemoryMismatch::MISSING, key, val.GetType(), MAX_DataType});
+        continue;
+      }
+      CompareAndAdd(key, val, other_val, result);
+    }
+    result.Trim();
+  }
+  return ReportMatch(other, result.num_lines, result.count, result.list);
+}
+
+VectorData FlatMemoryMap::Load(uint64_t addr) {
+  if (m_use_synthetic_memory) {
+    if (addr >= m_synthetic_base_address &&
+        addr < m_synthetic_base_address + m_synthetic_memory_size) {
+      uint32_t temp = addr & 0xfffff;
+      VectorData data(32, 1);
+      data.SetData((float)temp, 0);
+      return data;
+    }
+  }
+  VectorData data;
+  if (!TryLoad(addr, data))
+    throw std::runtime_error("FlatMemoryMap::Load failed");
+  return data;
+}
+
+void FlatMemoryMap::Store(uint64_t addr, VectorData data) {
+  assert(addr % PACKET_SIZE == 0);
+  assert(data.GetVlen() <= UINT8_MAX);
+  Page* page = GetOrAllocPage(addr);
+  uint64_t line = LineIndex(addr);
+  LineMeta& meta = page->meta[line];
+  if (meta.double_reg)
+    throw std::runtime_error("FlatMemoryMap::Double reg Stored!");
+  if (meta.type == EMPTY_LINE) m_num_lines++;
+  // double reg는 라인 하나에 담을 수 없음 (HashMemoryMap처럼 이후 접근에서 에러)
+  meta = LineMeta{(uint8_t)data.GetType(), (uint8_t)data.GetVlen(),
+                  data.GetDoubleReg()};
+  if (!meta.double_reg)
+    data.CopyLine(page->data + line * PACKET_SIZE);
+}
+
+bool FlatMemoryMap::CheckAddr(uint64_t addr) {
+  Page* page = FindPage(addr);
+  return page && page->meta[LineIndex(addr)].type != EMPTY_LINE;
+}
+
+bool FlatMemoryMap::TryLoad(uint64_t addr, VectorData& out) {
+  if (m_use_synthetic_memory) return MemoryMap::TryLoad(addr, out);
+  Page* page = FindPage(addr);
+  if (!page) return false;
+  uint64_t line = LineIndex(addr);
+  const LineMeta& meta = page->meta[line];
+  if (meta.type == EMPTY_LINE) return false;
+  if (meta.double_reg)
+    throw std::runtime_error("FlatMemoryMap::Double reg Stored!");
+  out.LoadLine(page->data + line * PACKET_SIZE, (DataType)meta.type,
+               meta.vlen);
+  return true;
+}
+
+void FlatMemoryMap::Reset() {
+  m_pages.clear();
+  m_image.reset();
+  m_num_lines = 0;
+  m_last_page_num = UINT64_MAX;
+  m_last_page = nullptr;
+  m_last_page_private = false;
+}
+
+std::vector<uint64_t> FlatMemoryMap::GetAddrs() const {
+  std::vector<uint64_t> addrs;
+  addrs.reserve(m_num_lines);
+  uint64_t lines = m_page_size / PACKET_SIZE;
+  for (auto& [page_num, page] : m_pages) {
+    uint64_t base = page_num << m_page_shift;
+    for (uint64_t i = 0; i < lines; i++)
+      if (page->meta[i].type != EMPTY_LINE)
+        addrs.push_back(base + i * PACKET_SIZE);
+  }
+  return addrs;
+}
+
+void FlatMemoryMap::DumpMemory() {
+  std::vector<uint64_t> addrs = GetAddrs();
+  std::sort(addrs.begin(), addrs.end());
+  for (uint64_t addr : addrs) spdlog::trace("{:x}: {}", addr, Load(addr).toString());
+}
+
 bool PointerMemoryMap::Match(MemoryMap& other2) {
   PointerMemoryMap& other = dynamic_cast<PointerMemoryMap&>(other2);
   bool result = true;
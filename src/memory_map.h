@@ -5,11 +5,25 @@
 
 #include <bitset>
 #include <cassert>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "common.h"
 namespace NDPSim {
 
+// Match에서 어긋난 라인 하나 (출력할 때 두 라인을 타입대로 해석)
+struct MemoryMismatch {
+  enum Kind { MISSING, TYPE, VALUE };
+  Kind kind;
+  uint64_t addr;
+  DataType type;        // this(정답) 라인 타입
+  DataType other_type;  // MISSING이면 MAX_DataType
+  int index;            // VALUE: 처음으로 다른 원소
+  uint8_t line[PACKET_SIZE];
+  uint8_t other_line[PACKET_SIZE];
+};
+
 class MemoryMap {
  public:
   virtual ~MemoryMap() = default;
@@ -17,19 +31,54 @@ class MemoryMap {
   static uint64_t FormatAddr(uint64_t addr) { return addr & ~(PACKET_SIZE - 1); }
 
   MemoryMap() {}
+  // backend: "hash" (HashMemoryMap) 또는 "flat" (FlatMemoryMap, page_size 페이지)
+  // file_path가 binary memory image(.mimg)면 backend와 상관없이 FlatMemoryMap
+  static MemoryMap* New(const std::string& backend,
+                        const std::string& file_path, uint64_t page_size);
   virtual bool Match(MemoryMap& other) = 0;
   virtual VectorData Load(uint64_t addr) = 0;
   virtual void Store(uint64_t addr, VectorData data) = 0;
   virtual bool CheckAddr(uint64_t addr) = 0;
+  // CheckAddr + Load in one step (false if addr is not mapped)
+  virtual bool TryLoad(uint64_t addr, VectorData& out) {
+    if (!CheckAddr(addr)) return false;
+    out = Load(addr);
+    return true;
+  }
   virtual void Reset() {}
   virtual void DumpMemory() {}
+  // 데이터가 있는 라인 주소들 (순서 없음, 라인 단위 backend만)
+  virtual std::vector<uint64_t> GetAddrs() const { return {}; }
+  // 현재 내용을 따로 떠 둔 map (이후 양쪽의 Store는 서로 영향 없음)
+  virtual MemoryMap* Snapshot();
+  // 내용을 snapshot(같은 backend) 시점으로 되돌림
+  virtual void Restore(const MemoryMap& snapshot);
+  // 곧 Store할 라인 수 (미리 공간 확보용)
+  virtual void ReserveLines(uint64_t num_lines) {}
   void set_synthetic_memory(uint64_t base, uint64_t size) {
     m_use_synthetic_memory = true;
     m_synthetic_base_address = base;
     m_synthetic_memory_size = size;
   }
   bool is_synthetic_memory() { return m_use_synthetic_memory; }
+  // 라인 하나 비교: 타입이 다르거나 값이 허용 오차(float 1%)를 넘으면
+  // mismatch를 채우고 false
+  static bool CompareLine(uint64_t key, const VectorData& val,
+                          const VectorData& other_val,
+                          MemoryMismatch& mismatch);
+  // Match 실패 시 자세히 출력할 불일치 라인 수 (주소가 작은 것부터)
+  void set_match_report_limit(int limit) { m_match_report_limit = limit; }
+  // memory map 텍스트 파일(_META_/_DATA_, gzip/zstd 압축 가능)을 여러
+  // 스레드로 파싱해 파일 순서대로 라인마다 Store
+  void ReadMemoryMapFile(const std::string& file_path);
  protected:
+  // 불일치 총 개수와 앞쪽 목록(주소 순)을 출력, 불일치가 없으면 true
+  bool ReportMatch(MemoryMap& other, uint64_t num_lines,
+                   uint64_t num_mismatches,
+                   const std::vector<MemoryMismatch>& mismatches);
+
+  int m_match_report_limit = 16;
+
   bool m_use_synthetic_memory = false;
   uint64_t m_synthetic_base_address;
   uint64_t m_synthetic_memory_size;
@@ -41,18 +90,99 @@ class HashMemoryMap : public MemoryMap {
   HashMemoryMap(std::string file_path);
   HashMemoryMap(uint64_t base, uint64_t size) : m_base(base), m_size(size){};
   virtual ~HashMemoryMap() override = default;
+  // 상대도 HashMemoryMap이면 여러 스레드로 비교
   virtual bool Match(MemoryMap& other) override;
   virtual VectorData Load(uint64_t addr) override;
   virtual void Store(uint64_t addr, VectorData data) override;
   virtual bool CheckAddr(uint64_t addr) override;
+  virtual bool TryLoad(uint64_t addr, VectorData& out) override;
   virtual void Reset() override;
   void DumpMemory() override;
+  std::vector<uint64_t> GetAddrs() const override;
+  void ReserveLines(uint64_t num_lines) override {
+    m_data_map.reserve(m_data_map.size() + num_lines);
+  }
+  // 라인 단위라 전체 복사
+  MemoryMap* Snapshot() override;
+  void Restore(const MemoryMap& snapshot) override;
 private:
   uint64_t m_size = 0;
   uint64_t m_base = 0; 
   robin_hood::unordered_map<uint64_t, VectorData> m_data_map;
 };
 
+// 2MB(설정 가능) 평면 페이지에 32B 라인을 그대로 저장하는 backend.
+// 페이지는 처음 Store할 때 할당하고(데이터 영역은 초기화하지 않아 실제로
+// 쓴 부분만 메모리를 차지), 페이지 번호 -> 페이지 directory와 마지막 페이지
+// 캐시로 찾는다. 라인마다 타입/vlen만 따로 두고 Load 때 VectorData로 만든다.
+// binary memory image(memory_image.h)는 파일을 MAP_PRIVATE로 매핑해서
+// 페이지가 매핑을 직접 가리킨다 (Store한 OS 페이지만 copy-on-write).
+// 페이지는 참조 카운트로 Snapshot/Restore한 map끼리 공유하고, 공유 중인
+// 페이지에 Store하면 그 페이지만 복사해서 쓴다.
+class FlatMemoryMap : public MemoryMap {
+ public:
+  static const uint64_t DEFAULT_PAGE_SIZE = 2 * 1024 * 1024;
+
+  explicit FlatMemoryMap(uint64_t page_size = DEFAULT_PAGE_SIZE);
+  // 텍스트 memory map 또는 binary image (image면 image의 페이지 크기)
+  FlatMemoryMap(std::string file_path, uint64_t page_size = DEFAULT_PAGE_SIZE);
+  virtual ~FlatMemoryMap() override = default;
+  // 상대도 같은 페이지 크기의 FlatMemoryMap이면 페이지 단위로 병렬 memcmp
+  virtual bool Match(MemoryMap& other) override;
+  virtual VectorData Load(uint64_t addr) override;
+  virtual void Store(uint64_t addr, VectorData data) override;
+  virtual bool CheckAddr(uint64_t addr) override;
+  virtual bool TryLoad(uint64_t addr, VectorData& out) override;
+  virtual void Reset() override;
+  void DumpMemory() override;
+  std::vector<uint64_t> GetAddrs() const override;
+  // 페이지 공유 (O(페이지 수))
+  MemoryMap* Snapshot() override;
+  void Restore(const MemoryMap& snapshot) override;
+  uint64_t GetNumPages() const { return m_pages.size(); }
+  uint64_t GetNumLines() const { return m_num_lines; }
+  uint64_t GetPageSize() const { return m_page_size; }
+  // binary memory image로 저장 / image를 매핑 (기존 내용은 버림)
+  void SaveImage(const std::string& path) const;
+  void MapImage(const std::string& path);
+
+ private:
+  // type == EMPTY_LINE이면 빈 라인 (타입 없이 Store한 라인은 MAX_DataType)
+  static const uint8_t EMPTY_LINE = 0xFF;
+  struct LineMeta {
+    uint8_t type;
+    uint8_t vlen;
+    bool double_reg;
+  };
+  struct Page {
+    uint8_t* data = nullptr;
+    LineMeta* meta = nullptr;
+    // image에서 매핑한 페이지는 소유 버퍼 없이 매핑을 가리킴
+    std::unique_ptr<uint8_t[]> own_data;
+    std::unique_ptr<LineMeta[]> own_meta;
+  };
+  // 없으면 nullptr
+  Page* FindPage(uint64_t addr);
+  // Store용: 다른 map과 공유 중인 페이지면 복사본으로 바꿔서 반환
+  Page* GetOrAllocPage(uint64_t addr);
+  std::shared_ptr<Page> ClonePage(const Page& page) const;
+  uint64_t LineIndex(uint64_t addr) const {
+    return (addr & (m_page_size - 1)) / PACKET_SIZE;
+  }
+
+  uint64_t m_page_size;
+  uint32_t m_page_shift;
+  uint64_t m_num_lines = 0;
+  robin_hood::unordered_map<uint64_t, std::shared_ptr<Page>> m_pages;
+  uint64_t m_last_page_num = UINT64_MAX;
+  Page* m_last_page = nullptr;
+  // m_last_page를 이 map만 가지고 있음 (Store 시 복사 불필요). 다른 map이
+  // 페이지를 가져가면(Snapshot/Restore) 그쪽에서 지움
+  mutable bool m_last_page_private = false;
+  // MapImage로 매핑한 파일 (마지막 참조가 사라질 때 munmap)
+  std::shared_ptr<void> m_image;
+};
+
 class PointerMemoryMap : public MemoryMap {
  public:
   PointerMemoryMap() : MemoryMap() {}
@@ -3,6 +3,11 @@
 #include "memory_map.h"
 #include "vector_data.h"
 #include "tlb.h"
+#include "page_table.h"
+#include "iommu.h"
+#include "tlb_array.h"
+#include "common_defs.h"
+#include <algorithm>
 #include <stdexcept>
 
 namespace NDPSim {
@@ -21,59 +26,221 @@ MMU::MMU(MemoryMap* mem, uint64_t pt_base, M2NDPConfig* cfg, Tlb* owner_tlb,
   uint32_t sh = 0;
   while ((1ULL << sh) < ps) sh++;
   m_page_shift = sh;
+  init_config();
 }
 
 bool MMU::Translate(uint64_t va, uint64_t& pa_out, bool /*is_write*/) {
-  const uint64_t pml4_i = idx_pml4(va);
-  const uint64_t pdpt_i = idx_pdpt(va);
-  const uint64_t pd_i   = idx_pd(va);
-  const uint64_t pt_i   = idx_pt(va);
-  const uint64_t off    = page_off(va);
-
-  uint64_t pml4e = read_qword(m_pt_base + pml4_i * 8);
-  if (!(pml4e & 0x1)) { m_stats.fails++; return false; }
-  uint64_t pdpt_base = pml4e & ~0xFFFULL;
-
-  uint64_t pdpte = read_qword(pdpt_base + pdpt_i * 8);
-  if (!(pdpte & 0x1)) { m_stats.fails++; return false; }
-  uint64_t pd_base = pdpte & ~0xFFFULL;
-
-  uint64_t pde = read_qword(pd_base + pd_i * 8);
-  if (!(pde & 0x1)) { m_stats.fails++; return false; }
-  uint64_t pt_base = pde & ~0xFFFULL;
-
-  uint64_t pte = read_qword(pt_base + pt_i * 8);
-  if (!(pte & 0x1)) { m_stats.fails++; return false; }
-  uint64_t frame = pte & ~0xFFFULL;
-
-  pa_out = frame | off;
-  m_stats.hits++;
-  return true;
+  invalidate_pte_lines();
+  uint64_t table_base = m_pt_base;
+  for (int level = 4; level >= 1; level--) {
+    uint64_t entry = read_qword(table_base + idx_level(va, level) * 8);
+    if (!(entry & PTE_PRESENT)) { m_stats.fails++; return false; }
+    if (is_leaf(entry, level)) {
+      pa_out = leaf_pa(entry, va, level);
+      m_stats.hits++;
+      return true;
+    }
+    table_base = entry & ~0xFFFULL;
+  }
+  // 여기 오면 안 됨
+  m_stats.fails++;
+  return false;
 }
 
-void MMU::submit(mem_fetch* orig_mf) {
-  // outstanding 제한이 있으면 리턴 (상위에서 다음 사이클 재시도)
-  if (m_max_outstanding_walks > 0 &&
-      (int)m_inflight.size() >= m_max_outstanding_walks) {
-    return;
+bool MMU::is_write_access(mem_fetch* mf) {
+  return mf->is_write() || mf->get_type() == WRITE_REQUEST ||
+         mf->get_access_type() == GLOBAL_ACC_W;
+}
+
+bool MMU::submit(mem_fetch* orig_mf, Tlb* requester) {
+  if (!requester) requester = m_owner_tlb;
+  uint64_t va = orig_mf->get_addr();
+  int asid = orig_mf->get_asid();
+
+  // prefetch buffer hit이면 walk 없이 완료
+  uint64_t pb_pa;
+  uint32_t pb_shift;
+  if (prefetch_buffer_lookup(asid, va, pb_pa, pb_shift)) {
+    m_stats.demand_misses++;
+    m_stats.prefetch_useful++;
+    orig_mf->set_addr(pb_pa);
+    if (m_cfg) orig_mf->set_channel(m_cfg->get_channel_index(pb_pa));
+    m_done[requester].push(Completed{orig_mf, va, pb_pa, pb_shift});
+    train_prefetcher(requester, asid, va);
+    return true;
+  }
+
+  // 같은 VPN의 walk가 진행(또는 대기) 중이면 거기에 합치고 새로 발행하지 않음
+  auto mshr = m_walk_mshr.find(walk_key(asid, va));
+  if (mshr != m_walk_mshr.end()) {
+    WalkCtx* pw = mshr->second;
+    m_stats.demand_misses++;
+    if (pw->prefetch && !pw->orig) {
+      // 진행 중인 prefetch walk를 demand가 이어받음 (late prefetch)
+      pw->orig      = orig_mf;
+      pw->va        = va;
+      pw->requester = requester;
+      pw->is_write  = is_write_access(orig_mf);
+      // walk latency는 demand가 기다린 시간만 집계
+      pw->submit_cycle = now();
+      pw->first_submit_cycle = pw->submit_cycle;
+      m_stats.prefetch_late++;
+    } else {
+      pw->merged.push_back(Waiter{orig_mf, va, requester});
+      // store가 합쳐지면 leaf에서 D 비트도 켜야 함
+      if (is_write_access(orig_mf)) pw->is_write = true;
+      m_stats.walk_merges++;
+    }
+    train_prefetcher(requester, asid, va);
+    return true;
+  }
+
+  // walker가 모두 바쁘고 대기 큐도 가득이면 backpressure (TLB가 다음 사이클 재시도)
+  if (walkers_busy() && m_walk_queue_size > 0 &&
+      (int)m_pending_walks.size() >= m_walk_queue_size) {
+    m_stats.submit_stalls++;
+    return false;
   }
 
   // PT walk 컨텍스트 생성
   auto* w = new WalkCtx();
   w->orig     = orig_mf;
-  w->va       = orig_mf->get_addr();
-  w->is_write = orig_mf->is_write() ||
-                orig_mf->get_type() == WRITE_REQUEST ||
-                orig_mf->get_access_type() == GLOBAL_ACC_W;
+  w->va       = va;
+  w->asid     = asid;
+  w->seq      = ++m_walk_seq;
+  w->pt_base  = pt_base_of(asid);
+  w->is_write = is_write_access(orig_mf);
+  w->requester    = requester;
+  w->submit_cycle = now();
+  w->first_submit_cycle = w->submit_cycle;
+  m_walk_mshr[walk_key(asid, va)] = w;
+
+  if (walkers_busy()) {
+    // 빈 walker가 생길 때까지 대기
+    m_pending_walks.push_back(w);
+    m_stats.max_pending_walks =
+        std::max<uint64_t>(m_stats.max_pending_walks, m_pending_walks.size());
+  } else {
+    start_walk(w);
+  }
+  m_stats.demand_misses++;
+  train_prefetcher(requester, asid, va);
+  return true;
+}
 
-  // 1단계: PML4 엔트리 라인 주소
-  uint64_t pml4_line = (m_pt_base + idx_pml4(w->va) * 8) & ~0x3FULL;
-  w->level     = 4;
-  w->next_addr = pml4_line;
+bool MMU::prefetch_buffer_lookup(int asid, uint64_t va, uint64_t& pa,
+                                 uint32_t& shift) {
+  for (auto it = m_prefetch_buffer.begin(); it != m_prefetch_buffer.end(); ++it) {
+    if (it->asid != asid || (it->va >> it->shift) != (va >> it->shift)) continue;
+    uint64_t mask = (1ULL << it->shift) - 1;
+    pa    = (it->pa & ~mask) | (va & mask);
+    shift = it->shift;
+    // TLB에 설치되므로 buffer에서는 뺌
+    m_prefetch_buffer.erase(it);
+    return true;
+  }
+  return false;
+}
+
+void MMU::prefetch_buffer_install(int asid, uint64_t va, uint64_t pa,
+                                  uint32_t shift) {
+  if (m_prefetch_buffer_entries <= 0) return;
+  if ((int)m_prefetch_buffer.size() >= m_prefetch_buffer_entries) {
+    m_prefetch_buffer.pop_front();
+    m_stats.prefetch_unused_evictions++;
+  }
+  m_prefetch_buffer.push_back(PrefetchEntry{asid, va, pa, shift});
+}
+
+bool MMU::prefetch_throttled() const {
+  // demand walk가 대기 중이거나 walker 점유율이 기준 이상이면 prefetch 안 함
+  if (!m_pending_walks.empty()) return true;
+  if (m_max_outstanding_walks <= 0) return false;
+  return m_active_walks * 100 >= m_max_outstanding_walks * m_prefetch_throttle;
+}
+
+void MMU::train_prefetcher(Tlb* requester, int asid, uint64_t va) {
+  if (m_prefetch_degree <= 0) return;
+  PrefetchStream& s = m_streams[requester];
+  uint64_t v = vpn(va);
+  // 같은 stride가 두 번 이상 보이면 다음 degree개 페이지를 prefetch
+  if (!s.train(asid, v)) return;
+
+  for (int k = 1; k <= m_prefetch_degree; k++) {
+    uint64_t pv = v + s.stride * k;
+    uint64_t pva = pv << m_page_shift;
+    bool in_buffer = false;
+    for (const PrefetchEntry& e : m_prefetch_buffer)
+      if (e.asid == asid && (e.va >> e.shift) == (pva >> e.shift)) {
+        in_buffer = true;
+        break;
+      }
+    if (in_buffer || m_walk_mshr.count(walk_key(asid, pva))) continue;
+    if (prefetch_throttled()) {
+      m_stats.prefetch_throttled++;
+      continue;
+    }
+    auto* w = new WalkCtx();
+    w->orig         = nullptr;
+    w->va           = pva;
+    w->asid         = asid;
+    w->seq          = ++m_walk_seq;
+    w->pt_base      = pt_base_of(asid);
+    w->prefetch     = true;
+    w->requester    = requester;
+    w->submit_cycle = now();
+    w->first_submit_cycle = w->submit_cycle;
+    m_walk_mshr[walk_key(asid, pva)] = w;
+    m_stats.prefetch_issued++;
+    start_walk(w);
+  }
+}
+
+void MMU::start_walk(WalkCtx* w) {
+  m_active_walks++;
+  uint64_t delay = now() - w->submit_cycle;
+  m_stats.queue_delay_sum += delay;
+  m_stats.max_queue_delay = std::max(m_stats.max_queue_delay, delay);
+  w->queue_cycles += delay;
+  w->start_cycle = now();
+
+  if (m_ats) {
+    start_ats(w);
+    return;
+  }
+
+  // PWC를 가장 깊은 레벨(PDE)부터 조회해서 walk 시작 레벨 결정
+  // (세 레벨은 병렬 조회로 보고, 활성화된 PWC 중 최대 latency를 부과)
+  w->level      = 4;
+  w->table_base = w->pt_base;
+  int pwc_latency = 0;
+  for (int level = 2; level <= 4; level++) {
+    PageWalkCache* pwc = pwc_for_level(level);
+    if (!pwc) continue;
+    pwc_latency = std::max(pwc_latency, pwc->latency());
+    uint64_t base;
+    bool hit = pwc->lookup(w->asid, w->va >> level_shift(level), base);
+    count_pwc(level, hit);
+    if (hit) {
+      w->level      = level - 1;
+      w->table_base = base;
+      break;
+    }
+  }
 
   m_stats.walks++;
+  if (m_nested) {
+    // guest 테이블 주소는 gPA: 첫 guest PTE부터 stage-2 변환
+    m_stats.nested_walks++;
+    begin_stage2(w, w->table_base + idx_level(w->va, w->level) * 8,
+                 /*final=*/false, pwc_latency);
+    return;
+  }
+
+  w->next_addr = (w->table_base + idx_level(w->va, w->level) * 8) &
+                 ~(uint64_t)(PACKET_SIZE - 1);
   // 첫 PTE line read 발행
-  issue_pt_read(w, w->next_addr);
+  issue_pt_read(w, w->next_addr, pwc_latency);
 }
 
 bool MMU::waiting_for_fill(mem_fetch* mf) const {
@@ -81,6 +248,10 @@ bool MMU::waiting_for_fill(mem_fetch* mf) const {
 }
 
 void MMU::on_mem_fill(mem_fetch* mf) {
+  m_fill_batch.push_back(mf);
+}
+
+void MMU::process_fill(mem_fetch* mf) {
   // Ramulator 경로에서 돌아온 PT 라인. 실제 데이터는 MemoryMap에서 로드.
   auto it = m_inflight.find(mf);
   if (it == m_inflight.end()) {
@@ -90,92 +261,453 @@ void MMU::on_mem_fill(mem_fetch* mf) {
   }
   WalkCtx* w = it->second;
   m_inflight.erase(it);
+  if (mf->is_page_fault()) {
+    on_fault_reply(mf, w);
+    return;
+  }
+  if (mf->is_ats_request()) {
+    on_ats_reply(mf, w);
+    return;
+  }
+  if (w->ad_pending) {
+    on_ad_reply(mf, w);
+    return;
+  }
   // PT 라인 fetch용 mf는 여기서 소멸
+  auto pt_read = m_pt_read_issue.find(mf);
+  if (pt_read != m_pt_read_issue.end()) {
+    m_stats.add_channel_read(mf->get_channel(), now() - pt_read->second);
+    m_pt_read_issue.erase(pt_read);
+  }
   delete mf;
+  if (w->s2_level > 0) {
+    process_s2_fill(w);
+    return;
+  }
 
-  // 현재 단계의 엔트리 읽고 다음 단계 진행
-  if (w->level == 4) {
-    uint64_t pml4e = read_qword(m_pt_base + idx_pml4(w->va) * 8);
-    if (!(pml4e & 0x1)) { m_stats.fails++; delete w; return; }
-    uint64_t pdpt_base = pml4e & ~0xFFFULL;
-
-    uint64_t pdpt_line = (pdpt_base + idx_pdpt(w->va) * 8) & ~0x3FULL;
-    w->level     = 3;
-    w->next_addr = pdpt_line;
+  // 현재 레벨 테이블에서 엔트리 하나만 읽음 (상위 레벨은 table_base에 이미 반영)
+  // nested면 stage-2로 변환해 둔 hPA에서 읽음
+  uint64_t entry_addr = m_nested
+      ? w->entry_hpa
+      : w->table_base + idx_level(w->va, w->level) * 8;
+  uint64_t entry = read_qword(entry_addr);
+  w->reads++;
+  if (m_nested) m_stats.guest_walk_reads++;
+  w->pte[w->level]      = entry;
+  w->pte_addr[w->level] = entry_addr;
+  if (!(entry & PTE_PRESENT)) {
+    if (w->orig && m_demand_paging)
+      raise_page_fault(w);
+    else
+      fail_walk(w, "not-present PTE (enable_demand_paging=0)");
+    return;
+  }
+  uint64_t next_base = entry & ~0xFFFULL;
+
+  if (!is_leaf(entry, w->level)) {
+    // 상위 레벨 엔트리는 PWC에 기록
+    if (PageWalkCache* pwc = pwc_for_level(w->level))
+      pwc->install(w->asid, w->va >> level_shift(w->level), next_base);
+
+    w->level--;
+    w->table_base = next_base;
+    if (m_nested) {
+      begin_stage2(w, next_base + idx_level(w->va, w->level) * 8, false);
+      return;
+    }
+    w->next_addr  = (next_base + idx_level(w->va, w->level) * 8) &
+                    ~(uint64_t)(PACKET_SIZE - 1);
     issue_pt_read(w, w->next_addr);
     return;
   }
 
-  if (w->level == 3) {
-    uint64_t pml4e     = read_qword(m_pt_base + idx_pml4(w->va) * 8);
-    uint64_t pdpt_base = pml4e & ~0xFFFULL;
-    uint64_t pdpte     = read_qword(pdpt_base + idx_pdpt(w->va) * 8);
-    if (!(pdpte & 0x1)) { m_stats.fails++; delete w; return; }
-    uint64_t pd_base = pdpte & ~0xFFFULL;
+  // leaf: PTE(4KB) 또는 PS 비트가 켜진 PDE(2MB)/PDPTE(1GB)
+  // (nested면 guest 테이블의 연속 gPA가 연속 hPA라는 보장이 없어 coalescing 안 함)
+  count_leaf(w->level);
+  w->coalesce_mask = (w->level == 1 && m_coalesce_pages > 1 && !m_nested)
+                         ? coalesce_run(w, entry) : 0;
+  w->pa_out     = leaf_pa(entry, w->va, w->level);
+  w->page_shift = (uint32_t)level_shift(w->level);
+  if (needed_ad_bits(w, entry)) {
+    // A/D RMW가 끝날 때까지 walker를 잡고 결과를 보관
+    issue_ad_update(w);
+    return;
+  }
+  w->dirty = (entry & PTE_DIRTY) != 0;
+  finish_guest_leaf(w);
+}
 
-    uint64_t pd_line = (pd_base + idx_pd(w->va) * 8) & ~0x3FULL;
-    w->level     = 2;
-    w->next_addr = pd_line;
-    issue_pt_read(w, w->next_addr);
+void MMU::finish_guest_leaf(WalkCtx* w) {
+  if (m_nested) {
+    begin_stage2(w, w->pa_out, /*final=*/true);
     return;
   }
+  complete_walk(w, w->pa_out, w->page_shift, w->coalesce_mask);
+}
 
-  if (w->level == 2) {
-    uint64_t pml4e     = read_qword(m_pt_base + idx_pml4(w->va) * 8);
-    uint64_t pdpt_base = pml4e & ~0xFFFULL;
-    uint64_t pdpte     = read_qword(pdpt_base + idx_pdpt(w->va) * 8);
-    uint64_t pd_base   = pdpte & ~0xFFFULL;
-    uint64_t pde       = read_qword(pd_base + idx_pd(w->va) * 8);
-    if (!(pde & 0x1)) { m_stats.fails++; delete w; return; }
-    uint64_t pt_base = pde & ~0xFFFULL;
+void MMU::begin_stage2(WalkCtx* w, uint64_t gpa, bool final, int extra_delay) {
+  w->s2_gpa   = gpa;
+  w->s2_final = final;
+  int latency = extra_delay;
+  if (m_nested_tlb.enabled()) {
+    latency += m_nested_tlb.latency();
+    uint64_t hpa_page;
+    if (m_nested_tlb.lookup(0, gpa >> 12, hpa_page)) {
+      m_stats.nested_tlb_hits++;
+      finish_stage2(w, hpa_page | (gpa & 0xFFF), 12, latency);
+      return;
+    }
+    m_stats.nested_tlb_misses++;
+  }
 
-    uint64_t pt_line = (pt_base + idx_pt(w->va) * 8) & ~0x3FULL;
-    w->level     = 1;
-    w->next_addr = pt_line;
-    issue_pt_read(w, w->next_addr);
+  // stage-2 PWC를 깊은 레벨부터 조회 (guest PWC와 같은 방식)
+  w->s2_level      = 4;
+  w->s2_table_base = m_stage2_pt_base;
+  if (m_s2_pwc.enabled()) {
+    latency += m_s2_pwc.latency();
+    for (int level = 2; level <= 4; level++) {
+      uint64_t base;
+      if (m_s2_pwc.lookup(0, s2_pwc_key(gpa, level), base)) {
+        m_stats.s2_pwc_hits++;
+        w->s2_level      = level - 1;
+        w->s2_table_base = base;
+        break;
+      }
+    }
+    if (w->s2_level == 4) m_stats.s2_pwc_misses++;
+  }
+  uint64_t entry_addr = w->s2_table_base + idx_level(gpa, w->s2_level) * 8;
+  issue_pt_read(w, entry_addr & ~(uint64_t)(PACKET_SIZE - 1), latency);
+}
+
+void MMU::process_s2_fill(WalkCtx* w) {
+  uint64_t entry_addr =
+      w->s2_table_base + idx_level(w->s2_gpa, w->s2_level) * 8;
+  uint64_t entry = read_qword(entry_addr);
+  w->reads++;
+  m_stats.host_walk_reads++;
+  if (!(entry & PTE_PRESENT)) {
+    // stage-2 fault(EPT violation)는 hypervisor 몫이라 모델링하지 않음
+    m_stats.s2_faults++;
+    fail_walk(w, "stage-2 fault (EPT violation)");
+    return;
+  }
+  uint64_t next_base = entry & ~0xFFFULL;
+  if (!is_leaf(entry, w->s2_level)) {
+    m_s2_pwc.install(0, s2_pwc_key(w->s2_gpa, w->s2_level), next_base);
+    w->s2_level--;
+    w->s2_table_base = next_base;
+    uint64_t next_addr = next_base + idx_level(w->s2_gpa, w->s2_level) * 8;
+    issue_pt_read(w, next_addr & ~(uint64_t)(PACKET_SIZE - 1));
     return;
   }
+  uint64_t hpa = leaf_pa(entry, w->s2_gpa, w->s2_level);
+  uint32_t shift = (uint32_t)level_shift(w->s2_level);
+  w->s2_level = 0;
+  m_nested_tlb.install(0, w->s2_gpa >> 12, hpa & ~0xFFFULL);
+  finish_stage2(w, hpa, shift, 0);
+}
+
+void MMU::finish_stage2(WalkCtx* w, uint64_t hpa, uint32_t s2_shift,
+                        int delay) {
+  if (!w->s2_final) {
+    // 다음 guest PTE를 hPA에서 읽음
+    w->entry_hpa = hpa;
+    issue_pt_read(w, hpa & ~(uint64_t)(PACKET_SIZE - 1), delay);
+    return;
+  }
+  // gVA→hPA 엔트리 크기는 guest leaf와 stage-2 leaf 중 작은 쪽
+  w->pa_out     = hpa;
+  w->page_shift = std::min(w->page_shift, s2_shift);
+  if (delay > 0) {
+    m_nested_hits.push_back(std::make_pair(now() + delay, w));
+    return;
+  }
+  complete_walk(w, w->pa_out, w->page_shift);
+}
+
+uint64_t MMU::needed_ad_bits(WalkCtx* w, uint64_t leaf_entry) const {
+  // 아무도 기다리지 않는 prefetch walk는 PTE를 건드리지 않음
+  if (!m_ad_update || !w->orig) return 0;
+  uint64_t bits = PTE_ACCESSED | (w->is_write ? PTE_DIRTY : 0);
+  return bits & ~leaf_entry;
+}
+
+void MMU::issue_ad_update(WalkCtx* w) {
+  // PTE 8B에 대한 atomic: L2에서 read 후 라인을 MODIFIED로 만듦 (RMW)
+  uint64_t pte_addr = w->pte_addr[w->level];
+  mem_fetch* mf = new mem_fetch(
+      pte_addr, TLB_ACC_R, READ_REQUEST,
+      /*data_size=*/8, CXL_OVERHEAD, /*timestamp=*/now());
+  mf->set_from_ndp(true);
+  mf->set_ndp_id(m_ndp_id);
+  mf->set_atomic(true);
+  if (m_cfg) mf->set_channel(m_cfg->get_channel_index(pte_addr));
+  w->ad_pending     = true;
+  w->ad_issue_cycle = now();
+  m_stats.ad_updates++;
+
+  m_inflight[mf] = w;
+  m_issue_q.push(mf, 0);
+}
 
-  // level == 1 (PTE)
-  if (w->level == 1) {
-    uint64_t pml4e     = read_qword(m_pt_base + idx_pml4(w->va) * 8);
-    uint64_t pdpt_base = pml4e & ~0xFFFULL;
-    uint64_t pdpte     = read_qword(pdpt_base + idx_pdpt(w->va) * 8);
-    uint64_t pd_base   = pdpte & ~0xFFFULL;
-    uint64_t pde       = read_qword(pd_base + idx_pd(w->va) * 8);
-    uint64_t pt_base   = pde & ~0xFFFULL;
-    uint64_t pte       = read_qword(pt_base + idx_pt(w->va) * 8);
+void MMU::on_ad_reply(mem_fetch* mf, WalkCtx* w) {
+  delete mf;
+  w->ad_pending = false;
+  m_stats.ad_latency_sum += now() - w->ad_issue_cycle;
+
+  // RMW 시점의 PTE에 비트를 켬 (RMW 동안 store가 합쳐졌으면 D도 함께)
+  PageTable pt(m_mem, w->pt_base, 0);
+  uint64_t pte_addr = w->pte_addr[w->level];
+  uint64_t entry = pt.read_entry(pte_addr);
+  uint64_t bits = (PTE_ACCESSED | (w->is_write ? PTE_DIRTY : 0)) & ~entry;
+  if (bits & PTE_ACCESSED) m_stats.ad_accessed++;
+  if (bits & PTE_DIRTY) m_stats.ad_dirty++;
+  if (bits) {
+    pt.write_entry(pte_addr, entry | bits);
+    invalidate_pte_lines();
+  }
+  w->dirty = ((entry | bits) & PTE_DIRTY) != 0;
+  finish_guest_leaf(w);
+}
 
-    if (!(pte & 0x1)) { m_stats.fails++; delete w; return; }
+uint64_t MMU::coalesce_run(WalkCtx* w, uint64_t leaf_entry) {
+  // leaf PTE와 같은 테이블의 정렬된 그룹을 보고, demand slot에서 위아래로
+  // PPN이 연속인 동안만 run을 늘림 (CoLT). demand 라인 밖의 PTE 라인은
+  // 기능적으로만 읽고 통계로 남김
+  uint64_t n     = m_coalesce_pages;
+  uint64_t idx   = idx_pt(w->va);
+  uint64_t first = idx & ~(n - 1);
+  int      slot  = (int)(idx - first);
+  uint64_t ppn   = (leaf_entry & ~0xFFFULL) >> 12;
+  uint64_t demand_line = (w->table_base + idx * 8) & ~(uint64_t)(PACKET_SIZE - 1);
+
+  auto contiguous = [&](int j) {
+    uint64_t addr = w->table_base + (first + j) * 8;
+    uint64_t e = load_qword(addr);
+    return (e & PTE_PRESENT) && !(e & PTE_PS) &&
+           ((e & ~0xFFFULL) >> 12) == ppn - slot + j;
+  };
+  uint64_t mask = 1ULL << slot;
+  for (int j = slot - 1; j >= 0 && contiguous(j); j--) mask |= 1ULL << j;
+  for (int j = slot + 1; j < (int)n && contiguous(j); j++) mask |= 1ULL << j;
+
+  uint64_t lines = 0;
+  for (uint64_t j = 0; j < n; j += PACKET_SIZE / 8) {
+    uint64_t line = (w->table_base + (first + j) * 8) & ~(uint64_t)(PACKET_SIZE - 1);
+    if (line != demand_line) lines++;
+  }
+  m_stats.coalesce_extra_lines += lines;
 
-    uint64_t frame = pte & ~0xFFFULL;
-    uint64_t pa    = frame | page_off(w->va);
+  uint64_t pages = __builtin_popcountll(mask);
+  if (pages > 1) {
+    m_stats.coalesced_walks++;
+    m_stats.coalesced_pages += pages;
+  }
+  return mask;
+}
 
-    w->pa_out = pa;
+void MMU::complete_walk(WalkCtx* w, uint64_t pa, uint32_t shift,
+                        uint64_t coalesce_mask) {
+  uint64_t mask = (1ULL << shift) - 1;
+  w->pa_out = pa;
+  record_walk_latency(w);
 
+  if (w->orig) {
     // 원본 mf를 PA로 교체
     w->orig->set_addr(pa);
     if (m_cfg) w->orig->set_channel(m_cfg->get_channel_index(pa));
 
-    // TLB가 SW 캐시에 설치할 수 있도록 VA/PA 함께 넘김
-    m_done.push(Completed{w->orig, w->va, pa});
-    delete w;
+    // TLB가 SW 캐시에 설치할 수 있도록 VA/PA와 leaf 크기를 함께 넘김
+    m_done[w->requester].push(
+        Completed{w->orig, w->va, pa, shift, coalesce_mask, w->dirty});
+  } else {
+    // demand가 없는 prefetch walk는 prefetch buffer로
+    prefetch_buffer_install(w->asid, w->va, pa, shift);
+  }
+
+  // 합쳐진 요청들도 같은 leaf로 완료 (페이지 오프셋만 각자)
+  for (Waiter& m : w->merged) {
+    uint64_t m_pa = (pa & ~mask) | (m.va & mask);
+    m.mf->set_addr(m_pa);
+    if (m_cfg) m.mf->set_channel(m_cfg->get_channel_index(m_pa));
+    m_done[m.requester].push(
+        Completed{m.mf, m.va, m_pa, shift, coalesce_mask, w->dirty});
+  }
+  release_walk(w);
+}
+
+void MMU::record_walk_latency(WalkCtx* w) {
+  w->memory_cycles += now() - w->start_cycle;
+  m_stats.reads_per_walk[std::min(w->reads, WalkStats::MAX_READS_PER_WALK)]++;
+  // 지연은 누군가 기다린 walk만 (demand가 이어받은 late prefetch 포함)
+  if (!w->orig) return;
+  m_stats.walk_latency.add(now() - w->first_submit_cycle);
+  m_stats.queue_latency.add(w->queue_cycles);
+  m_stats.memory_latency.add(w->memory_cycles);
+}
+
+void MMU::start_ats(WalkCtx* w) {
+  if (m_atc) {
+    uint64_t pa;
+    uint32_t shift;
+    if (m_atc->lookup(w->asid, w->va, pa, TLB_ACC_R, &shift)) {
+      m_stats.atc_hits++;
+      w->pa_out     = pa;
+      w->page_shift = shift;
+      m_atc_hits.push_back(std::make_pair(now() + m_atc_latency, w));
+      return;
+    }
+    m_stats.atc_misses++;
+  }
+
+  // ATC miss: host IOMMU로 ATS translation request
+  mem_fetch* mf = new mem_fetch(
+      w->va & ~0xFFFULL, TLB_ACC_R, READ_REQUEST,
+      /*data_size=*/8, CXL_OVERHEAD, /*timestamp=*/now());
+  mf->set_from_ndp(true);
+  mf->set_ndp_id(m_ndp_id);
+  mf->set_host_id(0);
+  mf->set_ats_request();
+  if (m_cfg) mf->set_channel(m_cfg->get_channel_index(mf->get_addr()));
+  AtsInfo* info = new AtsInfo();
+  info->va          = w->va;
+  info->pt_base     = w->pt_base;
+  info->asid        = w->asid;
+  info->is_write    = w->is_write;
+  info->issue_cycle = now();
+  mf->set_data(info);
+  m_stats.ats_requests++;
+
+  m_inflight[mf] = w;
+  m_issue_q.push(mf, m_atc ? m_atc_latency : 0);
+}
+
+void MMU::on_ats_reply(mem_fetch* mf, WalkCtx* w) {
+  AtsInfo* info = static_cast<AtsInfo*>(mf->get_data());
+  m_stats.ats_latency_sum += now() - info->issue_cycle;
+  bool success = info->success;
+  uint64_t pa = info->pa;
+  uint32_t shift = info->page_shift;
+  delete info;
+  delete mf;
+
+  if (!success) {
+    fail_walk(w, "ATS translation failed");
     return;
   }
+  if (m_atc) m_atc->install(w->asid, w->va, pa, shift);
+  complete_walk(w, pa, shift);
+}
 
-  // 여기 오면 안 됨
+void MMU::fail_walk(WalkCtx* w, const char* reason) {
+  if (!w->orig) {
+    // 아무도 기다리지 않는 prefetch walk는 그냥 버림 (merged도 비어 있음)
+    release_walk(w);
+    return;
+  }
+  // 원본과 합쳐진 요청이 모두 이 변환을 기다리므로 버리면 커널이 멈춤.
+  // LDST에는 변환 실패를 처리할 경로가 없으니 여기서 중단
+  m_stats.fails++;
+  spdlog::error("NDP {} MMU: {} for VA {:#x} (asid {}, {} waiting requests)",
+                m_ndp_id, reason, w->va, w->asid, 1 + w->merged.size());
+  exit(1);
+}
+
+void MMU::release_walk(WalkCtx* w) {
+  auto it = m_walk_mshr.find(walk_key(w->asid, w->va));
+  if (it != m_walk_mshr.end() && it->second == w) m_walk_mshr.erase(it);
   delete w;
+  m_active_walks--;
+  drain_pending_walks();
+}
+
+void MMU::drain_pending_walks() {
+  // walker가 비었으니 대기 중인 walk 시작
+  while (!walkers_busy() && !m_pending_walks.empty()) {
+    WalkCtx* next = m_pending_walks.front();
+    m_pending_walks.pop_front();
+    start_walk(next);
+  }
+}
+
+void MMU::raise_page_fault(WalkCtx* w) {
+  // fault 메시지는 BI처럼 CXL 링크를 타고 host로 감 (host_id 0이 처리)
+  mem_fetch* mf = new mem_fetch(
+      w->va & ~0xFFFULL, TLB_ACC_R, READ_REQUEST,
+      /*data_size=*/8, CXL_OVERHEAD, /*timestamp=*/now());
+  mf->set_from_ndp(true);
+  mf->set_ndp_id(m_ndp_id);
+  mf->set_host_id(0);
+  mf->set_page_fault();
+  if (m_cfg) mf->set_channel(m_cfg->get_channel_index(mf->get_addr()));
+  mf->set_data(new PageFaultInfo{w->va, w->pt_base, w->is_write, now()});
+  m_stats.page_faults++;
+
+  // host가 처리하는 동안 walker를 잡고 있지 않음
+  w->memory_cycles += now() - w->start_cycle;
+  m_inflight[mf] = w;
+  m_active_walks--;
+  drain_pending_walks();
+  m_issue_q.push(mf, 0);
+}
+
+void MMU::on_fault_reply(mem_fetch* mf, WalkCtx* w) {
+  PageFaultInfo* info = static_cast<PageFaultInfo*>(mf->get_data());
+  m_stats.fault_replays++;
+  m_stats.fault_latency_sum += now() - info->fault_cycle;
+  delete info;
+  delete mf;
+
+  // 매핑이 설치됐으니 walk를 처음부터 다시 (대기 walk보다 먼저)
+  w->submit_cycle = now();
+  if (walkers_busy()) {
+    m_pending_walks.push_front(w);
+  } else {
+    start_walk(w);
+  }
 }
 
 void MMU::cycle() {
   // PTW 발행 딜레이 큐 tick
   m_issue_q.cycle();
 
-  // 발행 준비된 요청이 있으면 TLB의 to-mem queue로 푸시
-  while (!m_issue_q.empty()) {
+  // 지난 cycle 동안 돌아온 fill을 한 번에 처리
+  if (!m_fill_batch.empty()) {
+    std::vector<mem_fetch*> batch;
+    batch.swap(m_fill_batch);
+    invalidate_pte_lines();
+    for (mem_fetch* mf : batch) process_fill(mf);
+  }
+
+  // ATC hit latency가 지난 ATS 변환 완료
+  while (!m_atc_hits.empty() && m_atc_hits.front().first <= now()) {
+    WalkCtx* w = m_atc_hits.front().second;
+    m_atc_hits.pop_front();
+    complete_walk(w, w->pa_out, w->page_shift);
+  }
+  // nested TLB hit로 끝난 stage-2 변환 완료
+  while (!m_nested_hits.empty() && m_nested_hits.front().first <= now()) {
+    WalkCtx* w = m_nested_hits.front().second;
+    m_nested_hits.pop_front();
+    complete_walk(w, w->pa_out, w->page_shift);
+  }
+
+  // walker 점유율 통계
+  m_stats.cycles++;
+  m_stats.busy_walker_cycles += m_active_walks;
+  m_stats.pending_walk_cycles += m_pending_walks.size();
+
+  // 발행 준비된 요청이 있으면 TLB의 to-mem queue로 푸시 (사이클당 issue rate 제한)
+  int issued = 0;
+  while (!m_issue_q.empty() &&
+         (m_ptw_issue_rate <= 0 || issued < m_ptw_issue_rate)) {
     mem_fetch* mf = m_issue_q.top();
     if (m_owner_tlb && m_owner_tlb->push_mem_req(mf)) {
       m_issue_q.pop();
+      issued++;
+      auto pt_read = m_pt_read_issue.find(mf);
+      if (pt_read != m_pt_read_issue.end()) pt_read->second = now();
     } else {
       // to-mem이 풀이라면 잠시 대기 (다음 cycle에 재시도)
       break;
@@ -183,47 +715,248 @@ void MMU::cycle() {
   }
 }
 
-MMU::Completed MMU::pop_completed() {
-  Completed c = m_done.front();
-  m_done.pop();
+void MMU::flush_asid(int asid) {
+  m_pml4e_cache.flush_asid(asid);
+  m_pdpte_cache.flush_asid(asid);
+  m_pde_cache.flush_asid(asid);
+  m_prefetch_buffer.erase(
+      std::remove_if(m_prefetch_buffer.begin(), m_prefetch_buffer.end(),
+                     [asid](const PrefetchEntry& e) { return e.asid == asid; }),
+      m_prefetch_buffer.end());
+}
+
+void MMU::flush() {
+  m_pml4e_cache.flush();
+  m_pdpte_cache.flush();
+  m_pde_cache.flush();
+  m_nested_tlb.flush();
+  m_s2_pwc.flush();
+  m_prefetch_buffer.clear();
+  // memory map이 되돌려졌을 수 있으므로 PTE 라인 사본도 버림
+  invalidate_pte_lines();
+}
+
+void MMU::invalidate_va(int asid, uint64_t va) {
+  for (int level = 2; level <= 4; level++)
+    if (PageWalkCache* pwc = pwc_for_level(level))
+      pwc->invalidate(asid, va >> level_shift(level));
+  m_prefetch_buffer.erase(
+      std::remove_if(m_prefetch_buffer.begin(), m_prefetch_buffer.end(),
+                     [&](const PrefetchEntry& e) {
+                       return (asid < 0 || e.asid == asid) &&
+                              (e.va >> e.shift) == (va >> e.shift);
+                     }),
+      m_prefetch_buffer.end());
+}
+
+bool MMU::walks_drained(uint64_t seq) const {
+  // MSHR에는 대기/진행/fault 처리 중인 walk가 모두 남아 있음
+  for (auto& it : m_walk_mshr)
+    if (it.second->seq <= seq) return false;
+  return true;
+}
+
+bool MMU::has_completed(Tlb* requester) const {
+  auto it = m_done.find(requester);
+  return it != m_done.end() && !it->second.empty();
+}
+
+MMU::Completed MMU::pop_completed(Tlb* requester) {
+  std::queue<Completed>& q = m_done[requester];
+  Completed c = q.front();
+  q.pop();
   return c;
 }
 
 uint64_t MMU::read_qword(uint64_t phys_addr) {
-  const uint64_t LINE = 64;
+  const uint64_t LINE = PACKET_SIZE;
   uint64_t base = phys_addr & ~(LINE - 1);
   uint32_t off  = static_cast<uint32_t>(phys_addr - base);
   if (off > (LINE - 8)) {
-    throw std::runtime_error("MMU: PTE crosses 64B line (unexpected)");
+    throw std::runtime_error("MMU: PTE crosses line boundary (unexpected)");
   }
-  VectorData v = m_mem->Load(base);
   m_stats.walk_reads++;
+  return load_qword(phys_addr);
+}
+
+uint64_t MMU::load_qword(uint64_t phys_addr) {
+  const uint64_t LINE = PACKET_SIZE;
+  uint64_t base = phys_addr & ~(LINE - 1);
+  uint32_t off  = static_cast<uint32_t>(phys_addr - base);
+  PteLine& line = m_pte_lines[(base / LINE) % PTE_LINE_CACHE_SIZE];
+  if (!line.valid || line.base != base) {
+    VectorData v;
+    line.base    = base;
+    line.valid   = true;
+    line.present = m_mem->TryLoad(base, v);
+    m_stats.functional_loads++;
+    if (line.present)
+      for (uint32_t i = 0; i < LINE; ++i) line.bytes[i] = v.GetU8Data(i);
+  }
+  if (!line.present) return 0;
   uint64_t val = 0;
   for (int i = 0; i < 8; ++i)
-    val |= (static_cast<uint64_t>(v.GetU8Data(off + i)) << (8 * i));
+    val |= (static_cast<uint64_t>(line.bytes[off + i]) << (8 * i));
   return val;
 }
 
-void MMU::issue_pt_read(WalkCtx* wctx, uint64_t pte_line_addr) {
+void MMU::invalidate_pte_lines() {
+  for (PteLine& line : m_pte_lines) line.valid = false;
+}
+
+void MMU::issue_pt_read(WalkCtx* wctx, uint64_t pte_line_addr, int extra_delay) {
   // 실제 Ramulator 경로로 보낼 mem_fetch 생성
-  // 64B 라인을 읽어오도록 data_size=64로 설정 (ctrl=CXL_OVERHEAD)
+  // PTE 라인 하나를 읽어오도록 data_size=PACKET_SIZE (ctrl=CXL_OVERHEAD)
   mem_fetch* mf = new mem_fetch(
       pte_line_addr, TLB_ACC_R, READ_REQUEST,
-      /*data_size=*/64, CXL_OVERHEAD,
+      /*data_size=*/PACKET_SIZE, CXL_OVERHEAD,
       /*timestamp=*/m_cfg ? m_cfg->get_ndp_cycle() : 0);
   mf->set_from_ndp(true);
   mf->set_ndp_id(m_ndp_id);
   if (m_cfg) mf->set_channel(m_cfg->get_channel_index(pte_line_addr));
 
   m_inflight[mf] = wctx;
+  m_pt_read_issue[mf] = 0;
 
-  if (m_ptw_issue_latency > 0) {
-    m_issue_q.push(mf, m_ptw_issue_latency);
+  if (m_ptw_issue_latency + extra_delay > 0) {
+    m_issue_q.push(mf, m_ptw_issue_latency + extra_delay);
   } else {
     // 즉시 발행 시도 (to-mem full이면 다음 cycle에 재시도해야 하므로 issue_q에 0으로 넣자)
     m_issue_q.push(mf, 0);
   }
 }
 
+void MMU::init_config() {
+  if (!m_cfg) return;
+  m_max_outstanding_walks = m_cfg->get_num_page_walkers();
+  m_walk_queue_size       = m_cfg->get_page_walk_queue_size();
+  m_ptw_issue_rate        = m_cfg->get_ptw_issue_rate();
+  m_demand_paging         = m_cfg->is_demand_paging_enabled();
+  m_ats                   = m_cfg->is_ats_enabled();
+  m_atc_latency           = m_cfg->get_atc_hit_latency();
+  m_coalesce_pages        = std::max(1, m_cfg->get_tlb_coalesce_pages());
+  // ATS 모드에서는 host IOMMU가 A/D를 관리
+  m_ad_update             = m_cfg->is_pte_ad_update_enabled() && !m_ats;
+  m_prefetch_degree       = m_cfg->get_tlb_prefetch_degree();
+  m_prefetch_buffer_entries = m_cfg->get_tlb_prefetch_buffer_entries();
+  m_prefetch_throttle     = m_cfg->get_tlb_prefetch_throttle();
+  m_pml4e_cache.init(m_cfg->get_pml4e_cache_config());
+  m_pdpte_cache.init(m_cfg->get_pdpte_cache_config());
+  m_pde_cache.init(m_cfg->get_pde_cache_config());
+  // nested 모드에서 ATS면 host IOMMU가 2D 변환까지 끝낸 hPA를 돌려줌
+  m_nested                = m_cfg->is_nested_paging_enabled() && !m_ats;
+  m_stage2_pt_base        = m_cfg->get_stage2_pt_base();
+  m_nested_tlb.init(m_nested ? m_cfg->get_nested_tlb_config() : "");
+  m_s2_pwc.init(m_nested ? m_cfg->get_stage2_pwc_config() : "");
+}
+
+PageWalkCache* MMU::pwc_for_level(int level) {
+  PageWalkCache* pwc = nullptr;
+  if (level == 4) pwc = &m_pml4e_cache;
+  else if (level == 3) pwc = &m_pdpte_cache;
+  else if (level == 2) pwc = &m_pde_cache;
+  return (pwc && pwc->enabled()) ? pwc : nullptr;
+}
+
+void MMU::count_leaf(int level) {
+  if (level == 1) m_stats.leaf_4k++;
+  else if (level == 2) m_stats.leaf_2m++;
+  else if (level == 3) m_stats.leaf_1g++;
+}
+
+void MMU::count_pwc(int level, bool hit) {
+  if (level == 4) (hit ? m_stats.pml4e_pwc_hits : m_stats.pml4e_pwc_misses)++;
+  else if (level == 3) (hit ? m_stats.pdpte_pwc_hits : m_stats.pdpte_pwc_misses)++;
+  else if (level == 2) (hit ? m_stats.pde_pwc_hits : m_stats.pde_pwc_misses)++;
+}
+
+/************** Page-walk cache **************/
+
+void PageWalkCache::init(const std::string& config) {
+  m_entries = 0;
+  m_tags.clear();
+  m_asids.clear();
+  m_bases.clear();
+  m_last_use.clear();
+  m_valid.clear();
+  if (config.empty()) return;
+
+  int entries = 0, assoc = 0, latency = 0;
+  if (sscanf(config.c_str(), "%d:%d:%d", &entries, &assoc, &latency) != 3 ||
+      entries <= 0 || assoc <= 0 || entries % assoc != 0) {
+    spdlog::error("Invalid page-walk cache config {}", config);
+    exit(1);
+  }
+  m_entries = entries;
+  m_assoc   = assoc;
+  m_sets    = entries / assoc;
+  m_latency = latency;
+  m_tags.assign(m_entries, 0);
+  m_asids.assign(m_entries, 0);
+  m_bases.assign(m_entries, 0);
+  m_last_use.assign(m_entries, 0);
+  m_valid.assign(m_entries, 0);
+}
+
+bool PageWalkCache::lookup(int asid, uint64_t key, uint64_t& base_out) {
+  if (!enabled()) return false;
+  int set = key % m_sets;
+  for (int way = 0; way < m_assoc; way++) {
+    int i = set * m_assoc + way;
+    if (m_valid[i] && m_asids[i] == asid && m_tags[i] == key) {
+      m_last_use[i] = ++m_clock;
+      base_out = m_bases[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+void PageWalkCache::install(int asid, uint64_t key, uint64_t base) {
+  if (!enabled()) return;
+  int set = key % m_sets;
+  int victim = -1;
+  // 이미 있으면 갱신, 없으면 invalid 우선, 그 다음 LRU
+  for (int way = 0; way < m_assoc; way++) {
+    int i = set * m_assoc + way;
+    if (m_valid[i] && m_asids[i] == asid && m_tags[i] == key) {
+      victim = i;
+      break;
+    }
+  }
+  if (victim < 0) {
+    victim = set * m_assoc;
+    for (int way = 0; way < m_assoc; way++) {
+      int i = set * m_assoc + way;
+      if (!m_valid[i]) { victim = i; break; }
+      if (m_last_use[i] < m_last_use[victim]) victim = i;
+    }
+  }
+  m_valid[victim]    = 1;
+  m_tags[victim]     = key;
+  m_asids[victim]    = asid;
+  m_bases[victim]    = base;
+  m_last_use[victim] = ++m_clock;
+}
+
+void PageWalkCache::flush() {
+  std::fill(m_valid.begin(), m_valid.end(), 0);
+}
+
+void PageWalkCache::flush_asid(int asid) {
+  for (int i = 0; i < m_entries; i++)
+    if (m_asids[i] == asid) m_valid[i] = 0;
+}
+
+void PageWalkCache::invalidate(int asid, uint64_t key) {
+  if (!enabled()) return;
+  int set = key % m_sets;
+  for (int way = 0; way < m_assoc; way++) {
+    int i = set * m_assoc + way;
+    if (m_valid[i] && (asid < 0 || m_asids[i] == asid) && m_tags[i] == key)
+      m_valid[i] = 0;
+  }
+}
+
 } // namespace NDPSim
 #endif // TIMING_SIMULATION
@@ -1,23 +1,115 @@
 #pragma once
 #ifdef TIMING_SIMULATION
 
+#include <algorithm>
 #include <cstdint>
 #include <unordered_map>
+#include <deque>
 #include <queue>
+#include <string>
+#include <vector>
+#include "common_defs.h"   // PACKET_SIZE
 #include "delay_queue.h"   // DelayQueue<T>
 #include "mem_fetch.h"     // NDPSim::mem_fetch
 #include "m2ndp_config.h"  // NDPSim::M2NDPConfig
+#include "tlb_stats.h"     // NDPSim::WalkStats
 
 namespace NDPSim {
 
 class MemoryMap;
 class Tlb;  // forward
+class TlbArray;
 
-// x86-64 4KB, 4-레벨(48-bit canonical) 테이블워크.
-// Page table 메모리는 64B 라인 단위(uint8)로 MemoryMap에 존재한다고 가정.
+// TLB prefetcher의 요청 TLB별 miss VPN stream. 새 VPN으로 가는 miss만
+// stride를 학습한다: 같은 VPN miss는 진행 중인 walk에 합쳐지는 MSHR merge라
+// 학습하면 stride 0이 끼어들어 page마다 여러 번 miss하는 scan이 confidence를
+// 쌓지 못한다.
+struct PrefetchStream {
+  int      asid = 0;
+  uint64_t last_vpn = 0;
+  int64_t  stride = 0;
+  int      confidence = 0;
+  bool     valid = false;
+
+  // miss 하나로 학습. 같은 stride가 두 번 이상 이어졌으면 true (prefetch)
+  bool train(int miss_asid, uint64_t vpn) {
+    // 다른 address space의 miss는 stream을 새로 시작
+    if (valid && asid != miss_asid) {
+      valid = false;
+      stride = 0;
+      confidence = 0;
+    }
+    if (valid && vpn == last_vpn) return false;
+    if (valid) {
+      int64_t new_stride = (int64_t)(vpn - last_vpn);
+      if (new_stride == stride) {
+        confidence = std::min(confidence + 1, 3);
+      } else {
+        stride = new_stride;
+        confidence = 0;
+      }
+    }
+    asid = miss_asid;
+    last_vpn = vpn;
+    valid = true;
+    return confidence >= 1;
+  }
+};
+
+// 상위 레벨 PTE(PML4E/PDPTE/PDE)를 담는 page-walk cache.
+// set-associative + LRU, tag는 (ASID, 해당 레벨까지의 VA 상위 비트),
+// 값은 다음 레벨 테이블의 물리 베이스. 배열은 flat하게 유지.
+// nested 모드의 nested TLB(gPA 페이지 → hPA 페이지)도 같은 구조를 쓴다.
+class PageWalkCache {
+public:
+  // "entries:assoc:latency" 형식 (빈 문자열이면 비활성)
+  void init(const std::string& config);
+
+  bool enabled() const { return m_entries > 0; }
+  int  latency() const { return m_latency; }
+
+  bool lookup(int asid, uint64_t key, uint64_t& base_out);
+  void install(int asid, uint64_t key, uint64_t base);
+  void flush();
+  void flush_asid(int asid);
+  // (asid, key) 엔트리 무효화 (asid < 0이면 모든 ASID)
+  void invalidate(int asid, uint64_t key);
+
+private:
+  int m_entries = 0;
+  int m_assoc   = 1;
+  int m_sets    = 0;
+  int m_latency = 0;
+  uint64_t m_clock = 0;
+
+  std::vector<uint64_t> m_tags;
+  std::vector<uint16_t> m_asids;
+  std::vector<uint64_t> m_bases;
+  std::vector<uint64_t> m_last_use; // LRU용 타임스탬프
+  std::vector<uint8_t>  m_valid;
+};
+
+// x86-64 4-레벨(48-bit canonical) 테이블워크. 4KB 외에 PDPTE/PDE의
+// PS 비트를 보고 1GB/2MB huge page에서 walk를 조기 종료한다.
+// Page table 메모리는 PACKET_SIZE 라인 단위(uint8)로 MemoryMap에 존재한다고 가정.
+// demand paging이 켜져 있으면 not-present 엔트리에서 host로 page fault를
+// 보내고, 응답이 오면 같은 walk를 처음부터 replay한다.
+// ATS 모드에서는 로컬 walk 대신 M2NDP 공유 ATC를 보고, miss면 host IOMMU로
+// ATS translation request를 보낸다 (walker 슬롯 = outstanding ATS 요청).
+// TLB prefetcher: 요청 TLB별 miss VPN stream에서 stride를 찾아 다음 N개
+// 페이지를 prefetch walk하고 결과를 prefetch buffer에 둔다. walker
+// 점유율이 높으면 prefetch walk를 내지 않는다.
+// 요청의 ASID마다 page table(pt_base)이 따로 있고, walk MSHR/PWC/prefetch
+// buffer는 ASID로 구분한다 (등록 안 된 ASID는 생성자의 pt_base).
+// A/D 비트 모델링을 켜면 leaf PTE에 A(첫 접근)/D(첫 store) 비트가 없을 때
+// L2를 거치는 locked RMW(atomic mem_fetch)를 보내고, 완료된 뒤 walk를 끝낸다.
+// nested 모드(가상화)에서는 guest 테이블이 guest-physical(gPA)에 있어서
+// guest PTE를 읽기 전마다, 그리고 leaf의 데이터 gPA를 stage-2(EPT) 테이블로
+// hPA 변환한다 (최대 4x5+4 = 24 reference). gPA→hPA는 nested TLB와
+// stage-2 PWC로 줄인다. stage-2 root는 하나(VM 하나)라 ASID로 구분하지 않음.
 class MMU {
 public:
-  // pt_base: PML4 물리 베이스 (예: 0x0009_0000_0000_0000)
+  // pt_base: ASID 0(기본)의 PML4 물리 베이스 (예: 0x0009_0000_0000_0000)
   // cfg, owner_tlb, ndp_id는 Ramulator 채널 계산과 to-mem push에 필요
   MMU(MemoryMap* mem, uint64_t pt_base,
       M2NDPConfig* cfg = nullptr, Tlb* owner_tlb = nullptr,
@@ -27,12 +119,16 @@ public:
   bool Translate(uint64_t va, uint64_t& pa_out, bool is_write);
 
   // 비동기 PT walk 제출 (TLB miss에서 호출)
-  void submit(mem_fetch* orig_mf);
+  // requester: 완료를 가져갈 TLB (nullptr이면 owner TLB). DTLB/ITLB가
+  // 같은 MMU를 공유하므로 완료 큐는 요청한 TLB별로 분리해서 보관한다.
+  // walker와 대기 큐가 모두 찬 경우 false (요청은 호출자가 보관)
+  bool submit(mem_fetch* orig_mf, Tlb* requester = nullptr);
 
   // Ramulator 경로로 보낸 PTW 메모리 요청이 돌아왔는지 확인하기 위해 TLB가 호출
   bool waiting_for_fill(mem_fetch* mf) const;
 
   // NdpUnit::from_mem_handle() -> Tlb::fill(mf) -> MMU 로 반납 (데이터는 MemoryMap에서 읽음)
+  // 돌아온 fill은 모아 두었다가 다음 cycle()에서 한 번에 처리
   void on_mem_fill(mem_fetch* mf);
 
   // TLB가 주기적으로 호출 (발행 queue, 내부 상태 갱신)
@@ -43,49 +139,225 @@ public:
     mem_fetch* mf;
     uint64_t   va;
     uint64_t   pa;
+    uint32_t   page_shift; // leaf 페이지 크기 (12/21/30)
+    // 4KB leaf와 같은 정렬 그룹에서 PPN이 연속인 slot bitmap (0이면 없음)
+    uint64_t   coalesce_mask = 0;
+    bool       dirty = false; // leaf PTE의 D 비트 (TLB 엔트리에 기록)
   };
-  bool has_completed() const { return !m_done.empty(); }
-  Completed pop_completed();
+  bool has_completed(Tlb* requester) const;
+  Completed pop_completed(Tlb* requester);
+
+  // store 요청인지 (walk의 D 비트 갱신, TLB의 clean 엔트리 판단에 사용)
+  static bool is_write_access(mem_fetch* mf);
+
+  // dirty가 아닌 TLB 엔트리에 store가 hit해서 D 비트를 위해 다시 walk함
+  void count_clean_write_hit() { m_stats.clean_write_hits++; }
+  bool ad_update_enabled() const { return m_ad_update; }
 
   // Trace/통계
-  struct Stats {
-    uint64_t walks=0, walk_reads=0, hits=0, fails=0;
-  };
+  using Stats = WalkStats;
   Stats GetStats() const { return m_stats; }
 
   // 바인딩/설정자
   void bind_tlb(Tlb* tlb)        { m_owner_tlb = tlb; }
-  void bind_config(M2NDPConfig* cfg) { m_cfg = cfg; }
+  void bind_config(M2NDPConfig* cfg) { m_cfg = cfg; init_config(); }
+  Tlb* get_owner_tlb() const { return m_owner_tlb; }
 
   // (선택) 소규모 issue 지연을 줄 값. 0이면 즉시 발행
   void set_ptw_issue_latency(int cyc) { m_ptw_issue_latency = cyc; }
 
-  // (선택) 최대 동시 워크 제한 (백프레셔/메모리 폭주 방지)
+  // ATS 모드에서 사용할 device-side ATC (M2NDP 공유, nullptr이면 없음)
+  void set_atc(TlbArray* atc) { m_atc = atc; }
+
+  // 같은 VPN의 walk가 진행(또는 대기) 중인지 (제출하면 MSHR에 합쳐짐)
+  bool is_walk_pending(int asid, uint64_t va) const {
+    return m_walk_mshr.find(walk_key(asid, va)) != m_walk_mshr.end();
+  }
+
+  // ASID의 page table 지정 (kernel launch 시 M2NDP가 설정)
+  void set_address_space(int asid, uint64_t pt_base) {
+    m_pt_bases[asid] = pt_base;
+  }
+  // ASID의 PWC/prefetch buffer 엔트리만 무효화, 또는 전부 무효화
+  void flush_asid(int asid);
+  void flush();
+  // shootdown: va의 상위 레벨 PWC 엔트리와 prefetch buffer 엔트리 무효화
+  // (asid < 0이면 모든 ASID)
+  void invalidate_va(int asid, uint64_t va);
+  // 지금까지 제출된 walk의 순번. walks_drained(seq)는 그 순번 이하의 walk가
+  // 모두 끝났는지 (shootdown ack 전에 in-flight 변환이 빠지길 기다림)
+  uint64_t get_walk_seq() const { return m_walk_seq; }
+  bool walks_drained(uint64_t seq) const;
+  // walker가 모두 바빠 새 walk는 대기 큐로 가야 하는지
+  bool is_saturated() const { return walkers_busy(); }
+
+  // (선택) 최대 동시 워크 제한 = HW walker 수 (0이면 무제한)
   void set_max_outstanding_walks(int n) { m_max_outstanding_walks = n; }
 
 private:
+  // 같은 VPN으로 진행 중인 walk에 합쳐져 기다리는 요청
+  struct Waiter {
+    mem_fetch* mf;
+    uint64_t   va;
+    Tlb*       requester;
+  };
+
   struct WalkCtx {
     mem_fetch* orig;      // 원본 요청
     uint64_t   va;
+    int        asid = 0;
+    uint64_t   seq = 0;     // 제출 순번 (shootdown drain 확인용)
+    uint64_t   pt_base = 0; // 이 ASID의 PML4 물리 베이스
     uint64_t   pa_out = 0;
     int        level = 4; // 4→3→2→1
-    uint64_t   next_addr; // 다음 읽을 PTE의 물리주소 (64B 라인 기준 정렬)
+    uint64_t   next_addr; // 다음 읽을 PTE의 물리주소 (PACKET_SIZE 라인 정렬)
+    uint64_t   table_base = 0; // 현재 레벨 테이블의 물리 베이스
     bool       is_write = false;
+    Tlb*       requester = nullptr;
+    uint64_t   submit_cycle = 0;  // walker 대기 시작 (fault replay 시 갱신)
+    uint64_t   first_submit_cycle = 0;
+    uint64_t   start_cycle = 0;   // 마지막으로 walker를 잡은 cycle
+    uint64_t   queue_cycles = 0;  // walker를 기다린 시간 누적
+    uint64_t   memory_cycles = 0; // walker를 잡고 있던 시간 누적
+    int        reads = 0;         // 이 walk가 읽은 PTE 라인 수
+    uint32_t   page_shift = 12; // ATC hit 시 leaf 크기
+    bool       prefetch = false; // prefetcher가 낸 walk (orig이 없을 수 있음)
+    // A/D RMW 진행 중이면 leaf 결과를 보관했다가 RMW 응답에서 완료
+    bool       ad_pending = false;
+    bool       dirty = false;
+    uint64_t   ad_issue_cycle = 0;
+    uint64_t   coalesce_mask = 0;
+    // 레벨별로 읽은 PTE 값과 그 물리주소 (index = level, 상위 레벨은 재조회 X)
+    uint64_t   pte[5] = {0, 0, 0, 0, 0};
+    uint64_t   pte_addr[5] = {0, 0, 0, 0, 0};
+    // nested walk: stage-2 walk 중이면 s2_level > 0. s2_final이면 guest
+    // leaf의 데이터 gPA, 아니면 다음에 읽을 guest PTE의 gPA를 변환 중
+    int        s2_level = 0;
+    bool       s2_final = false;
+    uint64_t   s2_gpa = 0;
+    uint64_t   s2_table_base = 0;
+    uint64_t   entry_hpa = 0; // 변환된 guest PTE의 hPA
+    std::vector<Waiter> merged; // walk MSHR에 합쳐진 요청들
   };
 
-  // 64B 라인 정렬 후 8B little-endian 로드 (기능적으로 메모리 내용 조회)
+  // walker를 할당받아 첫 PTE read 발행 (PWC 조회 포함)
+  void start_walk(WalkCtx* w);
+
+  // leaf PA(w->va 기준)로 원본과 합쳐진 요청들을 완료시키고 walk 해제
+  void complete_walk(WalkCtx* w, uint64_t pa, uint32_t page_shift,
+                     uint64_t coalesce_mask = 0);
+
+  // 완료 walk의 PTE read 수와 (demand walk면) 제출→완료 지연 기록
+  void record_walk_latency(WalkCtx* w);
+
+  // 4KB leaf 주변(정렬된 m_coalesce_pages 그룹)에서 PPN이 연속인 slot bitmap
+  uint64_t coalesce_run(WalkCtx* w, uint64_t leaf_entry);
+
+  // ATS 모드: ATC 조회 후 hit이면 ATC latency 뒤 완료, miss면 host로 요청
+  void start_ats(WalkCtx* w);
+  void on_ats_reply(mem_fetch* mf, WalkCtx* w);
+
+  // prefetch buffer 조회 (hit이면 엔트리를 꺼내 PA 반환)
+  bool prefetch_buffer_lookup(int asid, uint64_t va, uint64_t& pa,
+                              uint32_t& shift);
+  void prefetch_buffer_install(int asid, uint64_t va, uint64_t pa,
+                               uint32_t shift);
+  // demand miss VPN으로 stride 학습 후 prefetch walk 발행
+  void train_prefetcher(Tlb* requester, int asid, uint64_t va);
+  bool prefetch_throttled() const;
+
+  // leaf PTE에 새로 켜야 할 A/D 비트 (모델링이 꺼져 있거나 없으면 0)
+  uint64_t needed_ad_bits(WalkCtx* w, uint64_t leaf_entry) const;
+  // leaf PTE 라인에 locked RMW 발행 (L2 DataCache에서 atomic으로 처리)
+  void issue_ad_update(WalkCtx* w);
+  void on_ad_reply(mem_fetch* mf, WalkCtx* w);
+
+  // fill 하나 처리 (다음 레벨 발행 / leaf 완료 / fault·ATS·A/D 응답)
+  void process_fill(mem_fetch* mf);
+
+  // guest leaf(pa_out/page_shift) 이후: nested면 데이터 gPA를 stage-2로 변환
+  void finish_guest_leaf(WalkCtx* w);
+  // gPA→hPA 변환 시작 (nested TLB → stage-2 PWC → stage-2 PTE read)
+  void begin_stage2(WalkCtx* w, uint64_t gpa, bool final, int extra_delay = 0);
+  void process_s2_fill(WalkCtx* w);
+  // hPA를 얻은 뒤 guest PTE read 발행, 또는 (final) walk 완료
+  void finish_stage2(WalkCtx* w, uint64_t hpa, uint32_t s2_shift, int delay);
+  // stage-2 PWC는 레벨 셋을 한 배열에 둠 (key에 레벨 포함)
+  inline uint64_t s2_pwc_key(uint64_t gpa, int level) const {
+    return (gpa >> level_shift(level)) | ((uint64_t)level << 56);
+  }
+
+  // walk 완료/실패 시 MSHR/walker 해제 후 대기 walk 시작
+  void release_walk(WalkCtx* w);
+  // 변환 실패: prefetch walk면 버리고, 기다리는 요청이 있으면 VA를 출력하고
+  // 시뮬레이션 중단
+  void fail_walk(WalkCtx* w, const char* reason);
+
+  // not-present 엔트리: host로 page fault 발행, walker는 반납하고
+  // MSHR 엔트리는 유지 (fault 동안 같은 VPN 요청은 계속 합쳐짐)
+  void raise_page_fault(WalkCtx* w);
+  void on_fault_reply(mem_fetch* mf, WalkCtx* w);
+
+  // 빈 walker가 있으면 대기 중인 walk 시작
+  void drain_pending_walks();
+
+  bool walkers_busy() const {
+    return m_max_outstanding_walks > 0 &&
+           m_active_walks >= m_max_outstanding_walks;
+  }
+  uint64_t now() const { return m_cfg ? m_cfg->get_ndp_cycle() : 0; }
+
+  // PACKET_SIZE 라인 정렬 후 8B little-endian 로드 (기능적으로 메모리 내용 조회)
+  // 라인이 MemoryMap에 없으면 0 (not present)
   uint64_t read_qword(uint64_t phys_addr);
+  uint64_t load_qword(uint64_t phys_addr);  // 통계 없이 읽기
+  void invalidate_pte_lines();
 
   // 다음 단계의 PTE 라인을 Ramulator 경로로 읽도록 발행
-  void issue_pt_read(WalkCtx* wctx, uint64_t pte_line_addr);
+  void issue_pt_read(WalkCtx* wctx, uint64_t pte_line_addr, int extra_delay = 0);
+
+  // config에서 walker pool, page-walk cache 구성
+  void init_config();
+
+  // level(4=PML4E, 3=PDPTE, 2=PDE)에 해당하는 PWC, 없으면 nullptr
+  PageWalkCache* pwc_for_level(int level);
+  void count_pwc(int level, bool hit);
+
+  uint64_t pt_base_of(int asid) const {
+    auto it = m_pt_bases.find(asid);
+    return it == m_pt_bases.end() ? m_pt_base : it->second;
+  }
 
   // VA에서 인덱스/오프셋 계산
   inline uint64_t vpn(uint64_t va) const { return va >> m_page_shift; }
+  // walk MSHR key: 48-bit VA의 VPN 위에 ASID
+  inline uint64_t walk_key(int asid, uint64_t va) const {
+    return ((uint64_t)asid << 48) | vpn(va);
+  }
   inline uint64_t page_off(uint64_t va) const { return va & (m_page_size - 1); }
   inline uint64_t idx_pml4(uint64_t va) const { return (va >> 39) & 0x1FF; }
   inline uint64_t idx_pdpt(uint64_t va) const { return (va >> 30) & 0x1FF; }
   inline uint64_t idx_pd (uint64_t va) const { return (va >> 21) & 0x1FF; }
   inline uint64_t idx_pt (uint64_t va) const { return (va >> 12) & 0x1FF; }
+  inline uint64_t level_shift(int level) const { return 12 + 9 * (level - 1); }
+  // PDPTE(3)/PDE(2)의 PS 비트가 켜져 있으면 해당 엔트리가 leaf
+  inline bool is_leaf(uint64_t entry, int level) const {
+    return level == 1 || ((level == 2 || level == 3) && (entry & PTE_PS));
+  }
+  // leaf 엔트리 + VA → PA (leaf 크기에 맞춰 오프셋 결합)
+  inline uint64_t leaf_pa(uint64_t entry, uint64_t va, int level) const {
+    uint64_t mask = (1ULL << level_shift(level)) - 1;
+    return ((entry & ~0xFFFULL) & ~mask) | (va & mask);
+  }
+  void count_leaf(int level);
+
+  static constexpr uint64_t PTE_PRESENT = 0x1;
+  static constexpr uint64_t PTE_ACCESSED = 0x20;
+  static constexpr uint64_t PTE_DIRTY   = 0x40;
+  static constexpr uint64_t PTE_PS      = 0x80;
+  inline uint64_t idx_level(uint64_t va, int level) const {
+    return (va >> level_shift(level)) & 0x1FF;
+  }
 
 private:
   MemoryMap*     m_mem;
@@ -101,9 +373,46 @@ private:
 
   // inflight: ptw용 mem_fetch -> WalkCtx*
   std::unordered_map<mem_fetch*, WalkCtx*> m_inflight;
+  // PTE 라인 read -> to-mem 발행 cycle (채널별 walk 통계, 발행 전이면 0)
+  std::unordered_map<mem_fetch*, uint64_t> m_pt_read_issue;
+
+  // ASID -> PML4 물리 베이스 (없으면 m_pt_base)
+  std::unordered_map<int, uint64_t> m_pt_bases;
+
+  // walk MSHR: (ASID, 4KB VPN) -> 진행 중인 WalkCtx* (같은 VPN의 walk를 합침)
+  std::unordered_map<uint64_t, WalkCtx*> m_walk_mshr;
+  uint64_t m_walk_seq = 0;
 
-  // 완료된 원본 (VA/PA 함께 보관)
-  std::queue<Completed> m_done;
+  // 이번 cycle에 돌아온 fill (cycle()에서 batch 처리)
+  std::vector<mem_fetch*> m_fill_batch;
+
+  // batch 안에서 재사용하는 PTE 라인 (direct-mapped). 인접 VPN의 walk는
+  // 같은 PTE 라인을 읽으므로 MemoryMap 조회를 줄인다. host가 page table을
+  // 바꿀 수 있으므로 batch마다 무효화
+  static constexpr int PTE_LINE_CACHE_SIZE = 8;
+  struct PteLine {
+    uint64_t base = 0;
+    bool     valid = false;
+    bool     present = false;
+    uint8_t  bytes[PACKET_SIZE];
+  };
+  PteLine m_pte_lines[PTE_LINE_CACHE_SIZE];
+
+  // 완료된 원본 (VA/PA 함께 보관), 요청한 TLB별
+  std::unordered_map<Tlb*, std::queue<Completed>> m_done;
+
+  // 상위 레벨 page-walk cache
+  PageWalkCache m_pml4e_cache;
+  PageWalkCache m_pdpte_cache;
+  PageWalkCache m_pde_cache;
+
+  // nested 모드: stage-2 root(hPA), gPA 4KB 페이지 → hPA 페이지 nested TLB,
+  // stage-2 상위 레벨 PWC. nested TLB hit 완료는 latency 뒤 (FIFO)
+  bool m_nested = false;
+  uint64_t m_stage2_pt_base = 0;
+  PageWalkCache m_nested_tlb;
+  PageWalkCache m_s2_pwc;
+  std::deque<std::pair<uint64_t, WalkCtx*>> m_nested_hits;
 
   // 통계
   Stats m_stats;
@@ -111,8 +420,45 @@ private:
   // 발행 간격 (선택): 0이면 바로 push, 그 외면 m_issue_q 사용
   int m_ptw_issue_latency = 0; // 기본 0
 
-  // 최대 동시 워크 수 제한 (기본 0 = 무제한)
+  // 최대 동시 워크 수 = walker 수 (기본 0 = 무제한)
   int m_max_outstanding_walks = 0;
+  int m_active_walks = 0;
+
+  // walker를 기다리는 walk (m_walk_queue_size로 제한, 0 = 무제한)
+  std::deque<WalkCtx*> m_pending_walks;
+  int m_walk_queue_size = 0;
+
+  // 사이클당 DRAM으로 내보낼 수 있는 PTE read 수 (0 = 무제한)
+  int m_ptw_issue_rate = 0;
+
+  // not-present에서 host page fault를 낼지 (false면 walk 실패로 처리)
+  bool m_demand_paging = false;
+
+  // leaf PTE A/D 비트를 locked RMW 메모리 요청으로 갱신할지
+  bool m_ad_update = false;
+
+  // coalesced TLB 엔트리 그룹 크기 (1이면 끔)
+  int m_coalesce_pages = 1;
+
+  // TLB prefetcher
+  struct PrefetchEntry {
+    int      asid;
+    uint64_t va;
+    uint64_t pa;
+    uint32_t shift;
+  };
+  int m_prefetch_degree = 0;
+  int m_prefetch_buffer_entries = 0;
+  int m_prefetch_throttle = 100;
+  std::unordered_map<Tlb*, PrefetchStream> m_streams;
+  std::deque<PrefetchEntry> m_prefetch_buffer; // FIFO 교체
+
+  // ATS 모드 (translation을 host IOMMU에 맡김)
+  bool m_ats = false;
+  TlbArray* m_atc = nullptr;
+  int m_atc_latency = 0;
+  // ATC hit: (완료 cycle, walk), latency가 일정하므로 FIFO
+  std::deque<std::pair<uint64_t, WalkCtx*>> m_atc_hits;
 };
 
 } // namespace NDPSim
@@ -32,6 +32,13 @@ void NdpStats::clear() {
   m_itlb_stasts.clear();
   m_icache_stats.clear();
   m_dtlb_stats.clear();
+  m_stlb_stats.clear();
+  m_dtlb_coalesce_stats = TlbCoalesceStats();
+  m_stlb_coalesce_stats = TlbCoalesceStats();
+  m_dtlb_asid_stats = TlbAsidStats();
+  m_stlb_asid_stats = TlbAsidStats();
+  m_dtlb_batch_stats = TlbBatchStats();
+  m_walk_stats = WalkStats();
   m_l1d_stats.clear();
   m_l2d_stats.clear();
 }
@@ -94,6 +101,19 @@ NdpStats NdpStats::operator+(const NdpStats &other) {
   sum.m_itlb_stasts = m_itlb_stasts + other.m_itlb_stasts;
   sum.m_icache_stats = m_icache_stats + other.m_icache_stats;
   sum.m_dtlb_stats = m_dtlb_stats + other.m_dtlb_stats;
+  sum.m_stlb_stats = m_stlb_stats + other.m_stlb_stats;
+  sum.m_dtlb_coalesce_stats = m_dtlb_coalesce_stats;
+  sum.m_dtlb_coalesce_stats += other.m_dtlb_coalesce_stats;
+  sum.m_stlb_coalesce_stats = m_stlb_coalesce_stats;
+  sum.m_stlb_coalesce_stats += other.m_stlb_coalesce_stats;
+  sum.m_dtlb_asid_stats = m_dtlb_asid_stats;
+  sum.m_dtlb_asid_stats += other.m_dtlb_asid_stats;
+  sum.m_stlb_asid_stats = m_stlb_asid_stats;
+  sum.m_stlb_asid_stats += other.m_stlb_asid_stats;
+  sum.m_dtlb_batch_stats = m_dtlb_batch_stats;
+  sum.m_dtlb_batch_stats += other.m_dtlb_batch_stats;
+  sum.m_walk_stats = m_walk_stats;
+  sum.m_walk_stats += other.m_walk_stats;
   sum.m_l1d_stats = m_l1d_stats + other.m_l1d_stats;
   sum.m_l2d_stats = m_l2d_stats + other.m_l2d_stats;
   sum.m_register_stats = m_register_stats + other.m_register_stats;
@@ -148,6 +168,13 @@ NdpStats &NdpStats::operator+=(const NdpStats &other) {
   m_itlb_stasts += other.m_itlb_stasts;
   m_icache_stats += other.m_icache_stats;
   m_dtlb_stats += other.m_dtlb_stats;
+  m_stlb_stats += other.m_stlb_stats;
+  m_dtlb_coalesce_stats += other.m_dtlb_coalesce_stats;
+  m_stlb_coalesce_stats += other.m_stlb_coalesce_stats;
+  m_dtlb_asid_stats += other.m_dtlb_asid_stats;
+  m_stlb_asid_stats += other.m_stlb_asid_stats;
+  m_dtlb_batch_stats += other.m_dtlb_batch_stats;
+  m_walk_stats += other.m_walk_stats;
   m_l1d_stats += other.m_l1d_stats;
   m_l2d_stats += other.m_l2d_stats;
   m_register_stats += other.m_register_stats;
@@ -202,6 +229,47 @@ void NdpStats::print_stats_interval() {
   m_prev_issue_success_count = m_issue_success_count;
 }
 
+TranslationCounters NdpStats::get_translation_counters() const {
+  TranslationCounters c;
+  c.itlb_hits = m_itlb_stasts.get_hit();
+  c.itlb_misses = m_itlb_stasts.get_miss();
+  c.dtlb_hits = m_dtlb_stats.get_hit();
+  c.dtlb_misses = m_dtlb_stats.get_miss();
+  c.stlb_hits = m_stlb_stats.get_hit();
+  c.stlb_misses = m_stlb_stats.get_miss();
+  c.walks = m_walk_stats.walks;
+  c.walk_reads = m_walk_stats.walk_reads;
+  c.ad_updates = m_walk_stats.ad_updates;
+  c.demand_walks = m_walk_stats.walk_latency.count;
+  c.walk_latency_sum = m_walk_stats.walk_latency.sum;
+  c.queue_latency_sum = m_walk_stats.queue_latency.sum;
+  c.memory_latency_sum = m_walk_stats.memory_latency.sum;
+  c.mem_requests = m_memory_status[TO_MEM_PUSH_MY_CHANNEL] +
+                   m_memory_status[TO_MEM_PUSH_OTHER_CHANNEL];
+  return c;
+}
+
+std::string NdpStats::translation_summary(const TranslationCounters &c) {
+  return fmt::format(
+      "I-TLB hit {:.2f}%, D-TLB hit {:.2f}%, S-TLB hit {:.2f}%, walks {}, "
+      "walk latency {:.1f} (queue {:.1f}, memory {:.1f}), PTE reads/walk "
+      "{:.2f}, walk traffic {:.2f}%",
+      c.itlb_hit_rate() * 100, c.dtlb_hit_rate() * 100,
+      c.stlb_hit_rate() * 100, c.walks, c.avg_walk_latency(),
+      c.avg_queue_latency(), c.avg_memory_latency(), c.reads_per_walk(),
+      c.walk_traffic_share() * 100);
+}
+
+void NdpStats::print_translation_interval() {
+  TranslationCounters cur = get_translation_counters();
+  std::string summary = translation_summary(cur - m_prev_translation);
+  if (m_id == 0)
+    spdlog::info("NDP {:2}: {}", m_id, summary);
+  else
+    spdlog::debug("NDP {:2}: {}", m_id, summary);
+  m_prev_translation = cur;
+}
+
 void NdpStats::print_stats(FILE *out, const char *ndp_name) const {
   float issue_rate = ((float)m_issue_success_cycle) / m_cycle * 100;
   float avg_issue_count =
@@ -299,6 +367,27 @@ void NdpStats::print_stats(FILE *out, const char *ndp_name) const {
   m_icache_stats.print_stats(out, "L1I-Cache");
   fprintf(out, "=========D-TLB========\n");
   m_dtlb_stats.print_stats(out, "D-TLB");
+  if (m_dtlb_coalesce_stats.installs)
+    m_dtlb_coalesce_stats.print_stats(out, "D-TLB");
+  if (m_dtlb_asid_stats.cross_asid_evictions + m_dtlb_asid_stats.flushed_entries)
+    m_dtlb_asid_stats.print_stats(out, "D-TLB");
+  if (m_dtlb_batch_stats.merged)
+    m_dtlb_batch_stats.print_stats(out, "D-TLB");
+  fprintf(out, "=========S-TLB========\n");
+  m_stlb_stats.print_stats(out, "S-TLB");
+  if (m_stlb_coalesce_stats.installs)
+    m_stlb_coalesce_stats.print_stats(out, "S-TLB");
+  if (m_stlb_asid_stats.cross_asid_evictions + m_stlb_asid_stats.flushed_entries)
+    m_stlb_asid_stats.print_stats(out, "S-TLB");
+  fprintf(out, "=========Translation========\n");
+  TranslationCounters tc = get_translation_counters();
+  fprintf(out, "I-TLB hit rate: %.4f\n", tc.itlb_hit_rate());
+  fprintf(out, "D-TLB hit rate: %.4f\n", tc.dtlb_hit_rate());
+  fprintf(out, "S-TLB hit rate: %.4f\n", tc.stlb_hit_rate());
+  m_walk_stats.print_stats(out);
+  fprintf(out, "walk traffic: %lu of %lu memory requests (%.2f %%)\n",
+          tc.walk_traffic(), tc.walk_traffic() + tc.mem_requests,
+          tc.walk_traffic_share() * 100);
   fprintf(out, "=========L1-D Cache========\n");
   m_l1d_stats.print_stats(out, "L1-D Cache");
 }
@@ -332,6 +421,7 @@ void NdpStats::print_energy_stats(FILE *out) const {
   m_itlb_stasts.print_energy_stats(out, "ITLB");
   m_icache_stats.print_energy_stats(out, "L1I-CACHE");
   m_dtlb_stats.print_energy_stats(out, "DTLB");
+  m_stlb_stats.print_energy_stats(out, "STLB");
   m_l1d_stats.print_energy_stats(out, "L1D");
   m_l0_icache_stats.print_energy_stats(out, "L0I-CACHE");
 } 
@@ -2,6 +2,7 @@
 #ifndef NDP_STATS_H
 #define NDP_STATS_H
 #include "cache_stats.h"
+#include "tlb_stats.h"
 #include "register_unit.h"
 #include <list>
 #include <spdlog/fmt/ranges.h>
@@ -183,6 +184,13 @@ class NdpStats {
     void set_itlb_stats(CacheStats itlb) { m_itlb_stasts = itlb;}
     void set_icache_stats(CacheStats icache) { m_icache_stats = icache;}
     void set_dtlb_stats(CacheStats dtlb) { m_dtlb_stats = dtlb;}
+    void set_stlb_stats(CacheStats stlb) { m_stlb_stats = stlb;}
+    void set_dtlb_coalesce_stats(TlbCoalesceStats s) { m_dtlb_coalesce_stats = s; }
+    void set_stlb_coalesce_stats(TlbCoalesceStats s) { m_stlb_coalesce_stats = s; }
+    void set_dtlb_asid_stats(TlbAsidStats s) { m_dtlb_asid_stats = s; }
+    void set_dtlb_batch_stats(TlbBatchStats s) { m_dtlb_batch_stats = s; }
+    void set_stlb_asid_stats(TlbAsidStats s) { m_stlb_asid_stats = s; }
+    void set_walk_stats(const WalkStats &s) { m_walk_stats = s; }
     void set_l1d_stats(CacheStats dcache) { m_l1d_stats = dcache;}
     void set_l2d_stats(CacheStats dcache) { m_l2d_stats = dcache; }
     void set_regsiter_stats(RegisterStats reg) {m_register_stats = reg;}
@@ -224,6 +232,10 @@ class NdpStats {
     NdpStats operator+(const NdpStats &other);
     NdpStats &operator+=(const NdpStats &other);
     void print_stats_interval();
+    // 레벨별 TLB hit/miss, walk 지연, PTE read 수의 누적값
+    TranslationCounters get_translation_counters() const;
+    void print_translation_interval();
+    static std::string translation_summary(const TranslationCounters &c);
     void print_stats(FILE *out, const char *ndp_name="NdpStats") const;
     void print_energy_stats(FILE *out) const;
   private:
@@ -265,6 +277,13 @@ class NdpStats {
     CacheStats m_itlb_stasts;
     CacheStats m_icache_stats;
     CacheStats m_dtlb_stats;
+    CacheStats m_stlb_stats;
+    TlbCoalesceStats m_dtlb_coalesce_stats;
+    TlbCoalesceStats m_stlb_coalesce_stats;
+    TlbAsidStats m_dtlb_asid_stats;
+    TlbAsidStats m_stlb_asid_stats;
+    TlbBatchStats m_dtlb_batch_stats;
+    WalkStats m_walk_stats;
     CacheStats m_l1d_stats;
     CacheStats m_l2d_stats;
     CacheStats m_l0_icache_stats;
@@ -274,6 +293,7 @@ class NdpStats {
     uint64_t m_prev_issue_success_count;
     uint64_t m_prev_cache_access;
     uint64_t m_prev_cache_fill;
+    TranslationCounters m_prev_translation;
 
     uint64_t m_max_vreg_wb_per_cyc_per_sub_core = 0;
     uint64_t m_max_xreg_wb_per_cyc_per_sub_core = 0;
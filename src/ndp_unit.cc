@@ -5,6 +5,7 @@
 #include <fstream>
 #include <sstream>
 #include "mmu.h"
+#include "page_table.h"
 #include "ndp_instruction.h"
 #include "m2ndp_parser.h" 
 #include "spdlog/spdlog.h"
@@ -65,16 +66,26 @@ NdpUnit::NdpUnit(M2NDPConfig* config, MemoryMap* memory_map, NdpStats* stats,
   m_to_v_spad_unit.resize(
       m_num_sub_core, fifo_pipeline<std::pair<NdpInstruction, Context>>(
                          "to_v_spad_unit", 0, m_config->get_request_queue_size()));
-  m_dtlb = new Tlb(id, m_config, m_config->get_dtlb_config(), &m_tlb_req);
+  m_dtlb = new Tlb(id, m_config, m_config->get_dtlb_config(), &m_tlb_req,
+                   m_num_sub_core);
   m_itlb = new Tlb(id, m_config, m_config->get_itlb_config(), &m_tlb_req);
+  if (!m_config->get_stlb_config().empty()) {
+    m_stlb_config.init(m_config->get_stlb_config(), m_config);
+    m_stlb = new TlbArray("stlb", m_stlb_config,
+                          m_config->get_stlb_hit_latency());
+    m_stlb->set_coalesce_pages(std::max(1, m_config->get_tlb_coalesce_pages()));
+    m_dtlb->set_stlb(m_stlb);
+    m_itlb->set_stlb(m_stlb);
+  }
   if(m_config->get_ideal_tlb()) {
     m_dtlb->set_ideal_tlb();
     m_itlb->set_ideal_tlb();
   }
-  m_mmu = new MMU(m_memory_map, 0x0009000000000000ULL, m_config, m_dtlb, m_id);
+  m_mmu = new MMU(m_memory_map, PAGE_TABLE_BASE, m_config, m_dtlb, m_id);
   m_dtlb->set_mmu(m_mmu);
   m_itlb->set_mmu(m_mmu);
   m_uthread_generator = new UThreadGenerator(m_config, m_id, &m_matched_requests);
+  m_uthread_generator->set_tlb(m_dtlb);
   m_instruction_buffer =
       new InstructionBuffer(m_config->get_inst_buffer_size(),
                             m_config->get_request_queue_size(), m_id);
@@ -555,9 +566,61 @@ void NdpUnit::launch_ndp_kernel(KernelLaunchInfo info) {
   m_ldst_unit->set_l1d_size(m_uthread_generator->get_allocated_spad_size());
 }
 
-NdpStats NdpUnit::get_stats() {
+void NdpUnit::set_atc(TlbArray* atc) { m_mmu->set_atc(atc); }
+
+void NdpUnit::set_shared_tlb(SharedTlb* llt, int unit) {
+  m_dtlb->set_shared_tlb(llt, unit);
+  m_itlb->set_shared_tlb(llt, unit);
+}
+
+void NdpUnit::bind_address_space(int asid, uint64_t pt_base) {
+  m_mmu->set_address_space(asid, pt_base);
+}
+
+void NdpUnit::flush_asid(int asid) {
+  m_dtlb->flush_asid(asid);
+  m_itlb->flush_asid(asid);
+  if (m_stlb) m_stlb->flush_asid(asid);
+  m_mmu->flush_asid(asid);
+}
+
+void NdpUnit::flush_tlbs() {
+  m_dtlb->flush();
+  m_itlb->flush();
+  if (m_stlb) m_stlb->flush();
+  m_mmu->flush();
+}
+
+int NdpUnit::invalidate_va(int asid, uint64_t va) {
+  int count = m_dtlb->invalidate_va(asid, va) + m_itlb->invalidate_va(asid, va);
+  if (m_stlb) count += m_stlb->invalidate_va(asid, va);
+  m_mmu->invalidate_va(asid, va);
+  return count;
+}
+
+uint64_t NdpUnit::get_walk_seq() { return m_mmu->get_walk_seq(); }
+
+bool NdpUnit::walks_drained(uint64_t seq) { return m_mmu->walks_drained(seq); }
+
+void NdpUnit::update_translation_stats() {
   m_stats->set_itlb_stats(m_itlb->get_stats());
   m_stats->set_dtlb_stats(m_dtlb->get_stats());
+  if (m_stlb) m_stats->set_stlb_stats(m_stlb->get_stats());
+  m_stats->set_walk_stats(m_mmu->GetStats());
+}
+
+TranslationCounters NdpUnit::get_translation_counters() {
+  update_translation_stats();
+  return m_stats->get_translation_counters();
+}
+
+NdpStats NdpUnit::get_stats() {
+  update_translation_stats();
+  m_stats->set_dtlb_coalesce_stats(m_dtlb->get_coalesce_stats());
+  if (m_stlb) m_stats->set_stlb_coalesce_stats(m_stlb->get_coalesce_stats());
+  m_stats->set_dtlb_asid_stats(m_dtlb->get_asid_stats());
+  m_stats->set_dtlb_batch_stats(m_dtlb->get_batch_stats());
+  if (m_stlb) m_stats->set_stlb_asid_stats(m_stlb->get_asid_stats());
   m_stats->set_icache_stats(m_icache->get_stats());
   m_stats->set_l1d_stats(m_ldst_unit->get_l1d_stats());
   RegisterStats reg_stats;
@@ -583,6 +646,8 @@ void NdpUnit::print_ndp_stats() {
       m_sub_core_units[i]->print_sub_core_stats();
     }
   }
+  update_translation_stats();
+  m_stats->print_translation_interval();
 }
 
 void NdpUnit::print_uthread_stats() { m_uthread_generator->print_status(); }
@@ -18,7 +18,7 @@
 #include "uthread_generator.h"
 #endif
 
-namespace NDPSim { class MMU; }
+namespace NDPSim { class MMU; class SharedTlb; }
 namespace NDPSim {
 
 class NdpUnit {
@@ -42,10 +42,25 @@ class NdpUnit {
   void register_ndp_kernel(NdpKernel* ndp_kernel);
   void launch_ndp_kernel(KernelLaunchInfo info);
   NdpStats get_stats();
+  // 레벨별 TLB/walk 누적 카운터 (커널별 변환 통계용)
+  TranslationCounters get_translation_counters();
   void print_ndp_stats();
   void print_uthread_stats();
 
   bool generate_uthreads() { return m_uthread_generator->generate_uthreads(1); }
+  // ATS 모드에서 M2NDP 공유 ATC 연결
+  void set_atc(TlbArray* atc);
+  // M2NDP 공유 last-level TLB 연결 (unit: M2NDP 내 번호)
+  void set_shared_tlb(SharedTlb* llt, int unit);
+  // launch의 ASID → page table 등록, ASID 단위/전체 TLB·PWC 무효화
+  void bind_address_space(int asid, uint64_t pt_base);
+  void flush_asid(int asid);
+  void flush_tlbs();
+  // host TLB shootdown: va 페이지의 TLB/STLB/PWC 엔트리 무효화 (무효화한
+  // TLB 엔트리 수 반환). ack 전에 그 시점까지 제출된 walk가 끝나길 기다림
+  int invalidate_va(int asid, uint64_t va);
+  uint64_t get_walk_seq();
+  bool walks_drained(uint64_t seq);
 #endif
  private:
   MMU* m_mmu = nullptr;  // <-- 가드 밖으로 이동(항상 존재)
@@ -69,6 +84,8 @@ class NdpUnit {
   int m_sub_core_rr = 0; // Sub-core round-robin
   Tlb* m_dtlb;
   Tlb* m_itlb;
+  CacheConfig m_stlb_config;
+  TlbArray* m_stlb = nullptr;
   CacheConfig m_icache_config;
   Cache* m_icache;
   DelayQueue<mem_fetch*> m_icache_queue;
@@ -104,6 +121,8 @@ class NdpUnit {
   void l1_inst_cache_cycle();
   void to_l1_inst_cache();
   void tlb_cycle();
+  // TLB 배열/MMU 통계를 NdpStats로 복사
+  void update_translation_stats();
   void connect_to_ldst_unit();
   void connect_instruction_buffer_to_sub_core();
   void request_instruction_lookup();
@@ -0,0 +1,87 @@
+#include "page_table.h"
+
+#include <cassert>
+
+#include "common_defs.h"
+#include "memory_map.h"
+#include "vector_data.h"
+
+namespace NDPSim {
+
+PageTable::PageTable(MemoryMap* mem, uint64_t pt_base,
+                     uint64_t table_alloc_base)
+    : m_mem(mem), m_pt_base(pt_base), m_next_free(table_alloc_base) {}
+
+uint64_t PageTable::alloc_table() {
+  // 없는 라인은 0(not present)으로 읽히므로 zero-fill은 필요 없음
+  uint64_t table = m_next_free;
+  m_next_free += TABLE_SIZE;
+  m_allocated_tables++;
+  return table;
+}
+
+void PageTable::map(uint64_t va, uint64_t pa, uint32_t page_shift) {
+  assert(page_shift == 12 || page_shift == 21 || page_shift == 30);
+  int leaf_level = (page_shift - 12) / 9 + 1;
+  uint64_t table = m_pt_base;
+  for (int level = 4; level > leaf_level; level--) {
+    uint64_t entry_addr = table + idx_level(va, level) * 8;
+    uint64_t entry = read_entry(entry_addr);
+    if (!(entry & PTE_PRESENT) || (entry & PTE_PS)) {
+      uint64_t next = alloc_table();
+      write_entry(entry_addr, next | PTE_FLAGS);
+      table = next;
+    } else {
+      table = entry & ~0xFFFULL;
+    }
+  }
+  uint64_t mask = (1ULL << page_shift) - 1;
+  uint64_t leaf = (pa & ~mask) | PTE_FLAGS;
+  if (leaf_level > 1) leaf |= PTE_PS;
+  write_entry(table + idx_level(va, leaf_level) * 8, leaf);
+}
+
+bool PageTable::translate(uint64_t va, uint64_t& pa_out,
+                          uint32_t* shift_out) {
+  uint64_t table = m_pt_base;
+  for (int level = 4; level >= 1; level--) {
+    uint64_t entry = read_entry(table + idx_level(va, level) * 8);
+    if (!(entry & PTE_PRESENT)) return false;
+    if (level == 1 || ((level == 2 || level == 3) && (entry & PTE_PS))) {
+      uint64_t mask = (1ULL << level_shift(level)) - 1;
+      pa_out = ((entry & ~0xFFFULL) & ~mask) | (va & mask);
+      if (shift_out) *shift_out = level_shift(level);
+      return true;
+    }
+    table = entry & ~0xFFFULL;
+  }
+  return false;
+}
+
+uint64_t PageTable::read_entry(uint64_t entry_addr) {
+  uint64_t line = entry_addr & ~(uint64_t)(PACKET_SIZE - 1);
+  uint32_t off = entry_addr - line;
+  if (!m_mem->CheckAddr(line)) return 0;
+  VectorData data = m_mem->Load(line);
+  uint64_t val = 0;
+  for (int i = 0; i < 8; i++)
+    val |= (static_cast<uint64_t>(data.GetU8Data(off + i)) << (8 * i));
+  return val;
+}
+
+void PageTable::write_entry(uint64_t entry_addr, uint64_t value) {
+  uint64_t line = entry_addr & ~(uint64_t)(PACKET_SIZE - 1);
+  uint32_t off = entry_addr - line;
+  VectorData data(8, 1);
+  data.SetType(UINT8);
+  if (m_mem->CheckAddr(line)) {
+    data = m_mem->Load(line);
+  } else {
+    for (int i = 0; i < PACKET_SIZE; i++) data.SetData((uint8_t)0, i);
+  }
+  for (int i = 0; i < 8; i++)
+    data.SetData(static_cast<uint8_t>((value >> (8 * i)) & 0xFF), off + i);
+  m_mem->Store(line, data);
+}
+
+}  // namespace NDPSim
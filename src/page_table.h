@@ -0,0 +1,81 @@
+#ifndef PAGE_TABLE_H
+#define PAGE_TABLE_H
+
+#include <cstdint>
+
+namespace NDPSim {
+
+class MemoryMap;
+
+// PML4 물리 베이스 (CR3). make_pt.py의 --pt_base 기본값과 동일.
+static const uint64_t PAGE_TABLE_BASE = 0x0009000000000000ULL;
+// host fault handler가 새 테이블 페이지를 할당하는 영역 (make_pt가 만든
+// 테이블과 겹치지 않도록 PAGE_TABLE_BASE에서 1GB 떨어진 곳부터)
+static const uint64_t PAGE_TABLE_FAULT_POOL_OFFSET = 0x40000000ULL;
+// page_table_placement=replicate: NDP unit별 복제본 r의 root는
+// PAGE_TABLE_BASE + r * STRIDE (복제본 0이 원본)
+static const uint64_t PAGE_TABLE_REPLICA_STRIDE = 1ULL << 40;
+// nested 모드의 stage-2(EPT) root 기본값 (hPA, guest 테이블 영역과 분리)
+static const uint64_t STAGE2_PAGE_TABLE_BASE = 0x000A000000000000ULL;
+
+// NDP → host 로 보내는 page fault 메시지 (mem_fetch data로 전달)
+struct PageFaultInfo {
+  uint64_t va;
+  uint64_t pt_base;
+  bool is_write;
+  uint64_t fault_cycle;
+};
+
+// host → device TLB shootdown 메시지 (M2NDP마다 하나, reply가 ack).
+// [va, va + num_pages * 4KB)의 변환을 asid(< 0이면 전부)에서 무효화
+struct TlbInvalInfo {
+  uint64_t id;
+  uint64_t va;
+  uint64_t num_pages;
+  int asid;
+  uint64_t issue_cycle;
+  uint64_t invalidated = 0;  // device가 채움: 무효화한 TLB 엔트리 수
+};
+
+// MemoryMap 위의 x86-64 4-레벨 페이지 테이블을 기능적으로 읽고 쓰는 헬퍼.
+// 엔트리는 PACKET_SIZE 라인 단위 uint8 VectorData로 저장된다
+// (MMU::read_qword, make_pt.py와 같은 형식).
+class PageTable {
+ public:
+  PageTable(MemoryMap* mem, uint64_t pt_base, uint64_t table_alloc_base);
+
+  // va → pa 매핑 설치. page_shift 12/21/30 (4KB/2MB/1GB, 후자는 PS leaf).
+  // 필요한 중간 테이블은 table_alloc_base부터 할당.
+  void map(uint64_t va, uint64_t pa, uint32_t page_shift = 12);
+  // 기능적 walk. 성공하면 PA와 (선택적으로) leaf page shift를 돌려줌
+  bool translate(uint64_t va, uint64_t& pa_out, uint32_t* shift_out = nullptr);
+
+  uint64_t read_entry(uint64_t entry_addr);
+  void write_entry(uint64_t entry_addr, uint64_t value);
+
+  uint64_t get_pt_base() const { return m_pt_base; }
+  uint64_t get_allocated_tables() const { return m_allocated_tables; }
+
+  static constexpr uint64_t PTE_PRESENT = 0x1;
+  static constexpr uint64_t PTE_RW      = 0x2;
+  static constexpr uint64_t PTE_ACCESSED = 0x20;
+  static constexpr uint64_t PTE_DIRTY   = 0x40;
+  static constexpr uint64_t PTE_PS      = 0x80;
+  static constexpr uint64_t PTE_FLAGS   = PTE_PRESENT | PTE_RW;
+  static constexpr uint64_t TABLE_SIZE  = 4096;
+
+ private:
+  static uint32_t level_shift(int level) { return 12 + 9 * (level - 1); }
+  static uint64_t idx_level(uint64_t va, int level) {
+    return (va >> level_shift(level)) & 0x1FF;
+  }
+  uint64_t alloc_table();
+
+  MemoryMap* m_mem;
+  uint64_t m_pt_base;
+  uint64_t m_next_free;
+  uint64_t m_allocated_tables = 0;
+};
+
+}  // namespace NDPSim
+#endif
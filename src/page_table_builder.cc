@@ -0,0 +1,269 @@
+#include "page_table_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include "memory_map.h"
+#include "vector_data.h"
+
+namespace NDPSim {
+
+static constexpr uint64_t PTE_FLAGS = PageTable::PTE_FLAGS;
+static constexpr uint64_t PTE_PS = PageTable::PTE_PS;
+static constexpr uint64_t TABLE_SIZE = PageTable::TABLE_SIZE;
+
+PtMapPolicy PageTableBuildConfig::parse_policy(const std::string& name) {
+  if (name == "identity") return PtMapPolicy::IDENTITY;
+  if (name == "random") return PtMapPolicy::RANDOM;
+  if (name == "coloring") return PtMapPolicy::COLORING;
+  spdlog::error("Unknown page table policy: {}", name);
+  exit(1);
+}
+
+PtPlacement PageTableBuildConfig::parse_placement(const std::string& name) {
+  if (name == "contiguous") return PtPlacement::CONTIGUOUS;
+  if (name == "interleave" || name == "replicate")
+    return PtPlacement::INTERLEAVE;
+  if (name == "colocate") return PtPlacement::COLOCATE;
+  spdlog::error("Unknown page table placement: {}", name);
+  exit(1);
+}
+
+uint32_t PageTableBuildConfig::parse_page_shift(uint64_t page_size) {
+  if (page_size == 4096 || page_size == (1ULL << 21) ||
+      page_size == (1ULL << 30))
+    return __builtin_ctzll(page_size);
+  spdlog::error("Unsupported page table page size: {}", page_size);
+  exit(1);
+}
+
+PageTableBuilder::PageTableBuilder(const PageTableBuildConfig& config)
+    : m_config(config), m_rng(config.seed) {
+  assert(m_config.page_shift == 12 || m_config.page_shift == 21 ||
+         m_config.page_shift == 30);
+  assert(m_config.num_colors > 0);
+  m_page_size = 1ULL << m_config.page_shift;
+  // PML4는 pt_base, 나머지 테이블은 그 다음 페이지부터
+  m_next_table = m_config.pt_base + TABLE_SIZE;
+  m_num_tables = 1;
+  m_color_next.assign(m_config.num_colors, 0);
+  if (m_config.placement != PtPlacement::CONTIGUOUS) {
+    assert(m_config.channel_of && m_config.num_channels > 0);
+    m_next_channel = m_config.first_channel;
+  }
+}
+
+void PageTableBuilder::add_range(uint64_t va, uint64_t size) {
+  if (size == 0) return;
+  uint64_t first = va & ~(m_page_size - 1);
+  for (uint64_t page = first; page < va + size; page += m_page_size)
+    m_pages.push_back(page);
+}
+
+void PageTableBuilder::add_page(uint64_t va) {
+  m_pages.push_back(va & ~(m_page_size - 1));
+}
+
+void PageTableBuilder::add_memory_map(const MemoryMap& map) {
+  for (uint64_t addr : map.GetAddrs()) {
+    // page table 자체나 scratchpad는 매핑 대상이 아님. 먼저 기록된 다른
+    // 복제본/fault pool 테이블도 PAGE_TABLE_BASE 위에 있으므로 함께 제외
+    if (MemoryMap::CheckScratchpad(addr)) continue;
+    if (addr >= std::min(m_config.pt_base, PAGE_TABLE_BASE)) continue;
+    add_page(addr);
+  }
+}
+
+void PageTableBuilder::add_guest_physical(const PageTableBuilder& guest) {
+  add_range(guest.m_config.pt_base, guest.m_next_table - guest.m_config.pt_base);
+  for (uint64_t frame : guest.m_frames) add_range(frame, guest.m_page_size);
+}
+
+void PageTableBuilder::build() {
+  std::sort(m_pages.begin(), m_pages.end());
+  m_pages.erase(std::unique(m_pages.begin(), m_pages.end()), m_pages.end());
+
+  if (m_config.policy == PtMapPolicy::RANDOM && m_pool_frames == 0) {
+    // 매핑할 페이지의 4배 크기 풀에서 고름
+    m_pool_frames = std::max<uint64_t>(m_pages.size() * 4, 1024);
+  }
+  for (uint64_t page : m_pages) {
+    if (m_mapped.count(page)) continue;
+    uint64_t frame = alloc_frame(page);
+    map_page(page, frame);
+    m_mapped.insert(page);
+    m_frames.push_back(frame);
+  }
+  m_pages.clear();
+}
+
+uint64_t PageTableBuilder::alloc_frame(uint64_t va_page) {
+  uint64_t base_frame = m_config.frame_base >> m_config.page_shift;
+  switch (m_config.policy) {
+    case PtMapPolicy::IDENTITY:
+      return va_page;
+    case PtMapPolicy::RANDOM: {
+      if (m_pool_used >= m_pool_frames) {
+        spdlog::error("Page table builder: random frame pool exhausted ({})",
+                      m_pool_frames);
+        exit(1);
+      }
+      // [used, pool) 에서 하나 골라 used 자리와 교환
+      std::uniform_int_distribution<uint64_t> dist(m_pool_used,
+                                                   m_pool_frames - 1);
+      uint64_t pick = dist(m_rng);
+      auto value_at = [&](uint64_t i) {
+        auto it = m_swapped.find(i);
+        return it == m_swapped.end() ? i : it->second;
+      };
+      uint64_t frame = value_at(pick);
+      m_swapped[pick] = value_at(m_pool_used);
+      m_swapped.erase(m_pool_used);
+      m_pool_used++;
+      return (base_frame + frame) << m_config.page_shift;
+    }
+    case PtMapPolicy::COLORING: {
+      uint64_t colors = m_config.num_colors;
+      uint64_t color = (va_page >> m_config.page_shift) % colors;
+      uint64_t first = (base_frame + colors - 1) / colors * colors;
+      uint64_t frame = first + m_color_next[color]++ * colors + color;
+      return frame << m_config.page_shift;
+    }
+  }
+  return va_page;
+}
+
+void PageTableBuilder::map_page(uint64_t va_page, uint64_t pa_page) {
+  int leaf_level = (m_config.page_shift - 12) / 9 + 1;
+  uint64_t table = m_config.pt_base;
+  for (int level = 4; level > leaf_level; level--) {
+    uint64_t entry_addr = table + idx_level(va_page, level) * 8;
+    uint64_t entry = read_qword(entry_addr);
+    if (entry & PageTable::PTE_PRESENT) {
+      table = entry & ~0xFFFULL;
+    } else {
+      if (m_config.placement == PtPlacement::CONTIGUOUS) {
+        table = alloc_table();
+      } else {
+        int channel = m_config.placement == PtPlacement::COLOCATE
+                          ? m_config.channel_of(pa_page)
+                          : m_next_channel++ % m_config.num_channels;
+        table = alloc_table(channel, idx_level(va_page, level - 1) * 8);
+      }
+      write_qword(entry_addr, table | PTE_FLAGS);
+    }
+  }
+  uint64_t leaf = pa_page | PTE_FLAGS;
+  if (leaf_level > 1) leaf |= PTE_PS;
+  write_qword(table + idx_level(va_page, leaf_level) * 8, leaf);
+}
+
+uint64_t PageTableBuilder::alloc_table() {
+  uint64_t table = m_next_table;
+  m_next_table += TABLE_SIZE;
+  m_num_tables++;
+  return table;
+}
+
+uint64_t PageTableBuilder::alloc_table(int channel, uint64_t probe) {
+  for (size_t i = 0; i < m_spare_tables.size(); i++) {
+    uint64_t table = m_spare_tables[i];
+    if (m_config.channel_of(table + probe) != channel) continue;
+    m_spare_tables[i] = m_spare_tables.back();
+    m_spare_tables.pop_back();
+    m_num_tables++;
+    return table;
+  }
+  // 해시된 채널 매핑에서 못 찾을 수 있으니 채널 수의 4배까지만 찾고
+  // 없으면 가장 오래된 여분을 씀
+  for (int tries = 0; tries < 4 * m_config.num_channels; tries++) {
+    uint64_t table = m_next_table;
+    m_next_table += TABLE_SIZE;
+    if (m_config.channel_of(table + probe) == channel) {
+      m_num_tables++;
+      return table;
+    }
+    m_spare_tables.push_back(table);
+  }
+  uint64_t table = m_spare_tables.front();
+  m_spare_tables.erase(m_spare_tables.begin());
+  m_num_tables++;
+  return table;
+}
+
+uint64_t PageTableBuilder::read_qword(uint64_t addr) const {
+  uint64_t base = addr & ~(uint64_t)(PACKET_SIZE - 1);
+  auto it = m_lines.find(base);
+  if (it == m_lines.end()) return 0;
+  uint64_t val;
+  memcpy(&val, it->second.data() + (addr - base), sizeof(val));
+  return val;
+}
+
+void PageTableBuilder::write_qword(uint64_t addr, uint64_t value) {
+  uint64_t base = addr & ~(uint64_t)(PACKET_SIZE - 1);
+  auto it = m_lines.find(base);
+  if (it == m_lines.end()) {
+    Line zero{};
+    it = m_lines.emplace(base, zero).first;
+  }
+  memcpy(it->second.data() + (addr - base), &value, sizeof(value));
+}
+
+void PageTableBuilder::store_lines(MemoryMap* mem) const {
+  for (auto& [addr, line] : m_lines) {
+    VectorData data(8, 1);
+    data.SetType(UINT8);
+    for (int i = 0; i < PACKET_SIZE; i++) data.SetData(line[i], i);
+    mem->Store(addr, data);
+  }
+}
+
+void PageTableBuilder::write_to(PointerMemoryMap* mem) const {
+  // memory map이 해제하지 않으므로 시뮬레이션 동안 유지되는 버퍼
+  uint64_t size = m_next_table - m_config.pt_base;
+  uint8_t* buf = new uint8_t[size]();
+  for (auto& [addr, line] : m_lines)
+    memcpy(buf + (addr - m_config.pt_base), line.data(), PACKET_SIZE);
+  mem->AllocateMemory(m_config.pt_base, size, UINT8, buf);
+}
+
+void PageTableBuilder::write_to(MemoryMap* mem) const {
+  if (auto* ptr = dynamic_cast<PointerMemoryMap*>(mem)) {
+    write_to(ptr);
+  } else {
+    // 라인 단위 backend (HashMemoryMap / FlatMemoryMap)
+    store_lines(mem);
+  }
+}
+
+void PageTableBuilder::write_memmap(const std::string& path) const {
+  std::vector<uint64_t> addrs;
+  addrs.reserve(m_lines.size());
+  for (auto& [addr, line] : m_lines) addrs.push_back(addr);
+  std::sort(addrs.begin(), addrs.end());
+
+  std::ofstream ofs(path);
+  if (!ofs.good()) {
+    spdlog::error("Cannot open {}", path);
+    exit(1);
+  }
+  ofs << "_META_\nuint8\n_DATA_\n";
+  std::string out;
+  char buf[24];
+  for (uint64_t addr : addrs) {
+    const Line& line = m_lines.at(addr);
+    snprintf(buf, sizeof(buf), "0x%016lx", addr);
+    out = buf;
+    for (int i = 0; i < PACKET_SIZE; i++) {
+      out += ' ';
+      out += std::to_string(line[i]);
+    }
+    out += '\n';
+    ofs << out;
+  }
+}
+
+}  // namespace NDPSim
@@ -0,0 +1,131 @@
+#ifndef PAGE_TABLE_BUILDER_H
+#define PAGE_TABLE_BUILDER_H
+
+#include <robin_hood.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "page_table.h"
+
+namespace NDPSim {
+
+class MemoryMap;
+class PointerMemoryMap;
+
+// VA 페이지에 물리 프레임을 고르는 방식
+enum class PtMapPolicy {
+  IDENTITY,  // PA = VA (make_pt.py와 동일)
+  RANDOM,    // 프레임 풀에서 중복 없이 무작위
+  COLORING,  // VPN의 color(VPN % colors)를 유지하면서 프레임을 채움
+};
+
+// 테이블 페이지를 DRAM 채널에 놓는 방식
+enum class PtPlacement {
+  CONTIGUOUS,  // pt_base부터 순서대로 (make_pt.py와 동일)
+  INTERLEAVE,  // 새 테이블마다 채널을 돌아가며
+  COLOCATE,    // 처음 매핑하는 데이터 프레임과 같은 채널
+};
+
+struct PageTableBuildConfig {
+  PtMapPolicy policy = PtMapPolicy::IDENTITY;
+  uint32_t page_shift = 12;  // 12/21/30 (2MB/1GB는 PS leaf)
+  uint64_t pt_base = PAGE_TABLE_BASE;
+  uint64_t frame_base = 0;   // RANDOM/COLORING 프레임 영역 시작
+  int num_colors = 16;
+  uint64_t seed = 1;
+  // INTERLEAVE/COLOCATE는 channel_of(주소)로 채널을 판단
+  PtPlacement placement = PtPlacement::CONTIGUOUS;
+  int num_channels = 1;
+  int first_channel = 0;  // INTERLEAVE 시작 채널 (복제본마다 다르게)
+  std::function<int(uint64_t)> channel_of;
+
+  // "identity" / "random" / "coloring"
+  static PtMapPolicy parse_policy(const std::string& name);
+  // "contiguous" / "interleave" / "colocate" (replicate는 interleave 복제본)
+  static PtPlacement parse_placement(const std::string& name);
+  // 4KB / 2MB / 1GB 페이지 크기 -> page_shift
+  static uint32_t parse_page_shift(uint64_t page_size);
+};
+
+// 커널이 쓰는 VA 범위를 모아 x86-64 4-레벨 페이지 테이블을 만들고
+// MemoryMap에 바로 기록한다 (make_pt.py + _pt.data 텍스트 파싱 대체).
+// 테이블은 PACKET_SIZE 라인 버퍼에서 만든 뒤 한 번에 옮긴다.
+// 테이블 페이지는 pt_base부터 순서대로 할당 (PML4 = pt_base). INTERLEAVE/
+// COLOCATE면 walk가 읽을 PTE 라인이 목표 채널에 오는 페이지를 고르고,
+// 건너뛴 페이지는 다른 채널용 여분으로 남겨 둔다.
+class PageTableBuilder {
+ public:
+  explicit PageTableBuilder(const PageTableBuildConfig& config);
+
+  // [va, va + size)가 걸치는 모든 페이지
+  void add_range(uint64_t va, uint64_t size);
+  void add_page(uint64_t va);
+  // 데이터가 있는 라인이 속한 페이지 (input/output memory map, 라인 단위
+  // backend만 주소 목록이 있음)
+  void add_memory_map(const MemoryMap& map);
+  // nested 모드의 stage-2 테이블용: guest 테이블 페이지와 guest가 매핑한
+  // 프레임(gPA) 전부 (guest.build() 이후)
+  void add_guest_physical(const PageTableBuilder& guest);
+
+  // 페이지 테이블 구성 (여러 번 불러도 새로 추가된 페이지만 매핑)
+  void build();
+  // 구성한 테이블 라인을 memory map에 기록
+  // PointerMemoryMap은 [pt_base, 테이블 끝) 한 덩어리를 uint8로 할당해서 넘김
+  void write_to(PointerMemoryMap* mem) const;
+  void write_to(MemoryMap* mem) const;
+  // memory map 텍스트 형식(uint8)으로 저장 (CLI용)
+  void write_memmap(const std::string& path) const;
+
+  uint64_t get_num_pages() const { return m_mapped.size(); }
+  uint64_t get_num_tables() const { return m_num_tables; }
+  uint64_t get_num_lines() const { return m_lines.size(); }
+  uint64_t get_table_end() const { return m_next_table; }
+
+ private:
+  using Line = std::array<uint8_t, PACKET_SIZE>;
+
+  // 라인마다 uint8 VectorData로 Store
+  void store_lines(MemoryMap* mem) const;
+  uint64_t read_qword(uint64_t addr) const;
+  void write_qword(uint64_t addr, uint64_t value);
+  uint64_t alloc_table();
+  // va의 walk가 새 테이블에서 읽을 엔트리(probe)가 channel에 오는 페이지
+  uint64_t alloc_table(int channel, uint64_t probe);
+  uint64_t alloc_frame(uint64_t va_page);
+  void map_page(uint64_t va_page, uint64_t pa_page);
+
+  static uint32_t level_shift(int level) { return 12 + 9 * (level - 1); }
+  static uint64_t idx_level(uint64_t va, int level) {
+    return (va >> level_shift(level)) & 0x1FF;
+  }
+
+  PageTableBuildConfig m_config;
+  uint64_t m_page_size;
+  uint64_t m_next_table;
+  uint64_t m_num_tables = 0;
+  // INTERLEAVE/COLOCATE: 목표 채널이 맞지 않아 건너뛴 테이블 페이지
+  std::vector<uint64_t> m_spare_tables;
+  uint64_t m_next_channel = 0;
+
+  std::vector<uint64_t> m_pages;  // 아직 매핑 안 한 VA 페이지 (중복 포함)
+  robin_hood::unordered_set<uint64_t> m_mapped;
+  std::vector<uint64_t> m_frames;  // 매핑한 물리 프레임 (stage-2 구성용)
+  robin_hood::unordered_map<uint64_t, Line> m_lines;
+
+  // RANDOM: 프레임 풀 위의 sparse Fisher-Yates (섞인 자리만 저장)
+  std::mt19937_64 m_rng;
+  uint64_t m_pool_frames = 0;
+  uint64_t m_pool_used = 0;
+  robin_hood::unordered_map<uint64_t, uint64_t> m_swapped;
+  // COLORING: color별 다음 프레임 번호
+  std::vector<uint64_t> m_color_next;
+};
+
+}  // namespace NDPSim
+#endif
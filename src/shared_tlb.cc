@@ -0,0 +1,137 @@
+#ifdef TIMING_SIMULATION
+#include "shared_tlb.h"
+
+#include <string>
+
+#include "mem_fetch.h"
+
+namespace NDPSim {
+
+SharedTlb::SharedTlb(M2NDPConfig* config, int num_units)
+    : m_config(config), m_num_units(num_units) {
+  m_num_banks    = m_config->get_shared_tlb_banks();
+  m_ports        = m_config->get_shared_tlb_ports();
+  m_hit_latency  = m_config->get_shared_tlb_hit_latency();
+  m_xbar_latency = m_config->get_shared_tlb_xbar_latency();
+  m_queue_size   = m_config->get_request_queue_size();
+  assert(m_num_banks > 0 && m_ports > 0);
+
+  m_bank_config.init(m_config->get_shared_tlb_config(), m_config);
+  for (int b = 0; b < m_num_banks; b++)
+    m_banks.push_back(new TlbArray("shared_tlb_" + std::to_string(b),
+                                   m_bank_config, m_hit_latency));
+  m_bank_queues.resize(m_num_banks);
+  m_unit_hits.assign(m_num_units, 0);
+  m_unit_misses.assign(m_num_units, 0);
+}
+
+SharedTlb::~SharedTlb() {
+  for (TlbArray* bank : m_banks) delete bank;
+}
+
+bool SharedTlb::can_access(uint64_t va) {
+  if ((int)m_bank_queues[bank_of(va)].size() < m_queue_size) return true;
+  m_queue_full_stalls++;
+  return false;
+}
+
+void SharedTlb::access(int unit, Tlb* requester, mem_fetch* mf) {
+  // crossbar를 건너 bank에 도착하는 시각
+  m_bank_queues[bank_of(mf->get_addr())].push_back(
+      Request{now() + m_xbar_latency, unit, requester, mf});
+}
+
+bool SharedTlb::has_response(Tlb* requester) const {
+  auto it = m_responses.find(requester);
+  return it != m_responses.end() && !it->second.empty();
+}
+
+SharedTlb::Response SharedTlb::pop_response(Tlb* requester) {
+  std::queue<Response>& q = m_responses[requester];
+  Response r = q.front();
+  q.pop();
+  return r;
+}
+
+void SharedTlb::fill(int asid, uint64_t va, uint64_t pa,
+                     uint32_t page_shift) {
+  if (page_shift == 12) {
+    m_banks[bank_of(va)]->install(asid, va, pa, page_shift);
+    return;
+  }
+  // bank는 4KB VPN으로 고르므로 huge page는 모든 bank에 있어야 조회됨
+  for (TlbArray* bank : m_banks) bank->install(asid, va, pa, page_shift);
+}
+
+void SharedTlb::flush_asid(int asid) {
+  for (TlbArray* bank : m_banks) bank->flush_asid(asid);
+}
+
+void SharedTlb::flush() {
+  for (TlbArray* bank : m_banks) bank->flush();
+}
+
+int SharedTlb::invalidate_va(int asid, uint64_t va) {
+  // huge page 엔트리는 모든 bank에 복제되어 있으므로 전부 확인
+  int count = 0;
+  for (TlbArray* bank : m_banks) count += bank->invalidate_va(asid, va);
+  return count;
+}
+
+void SharedTlb::cycle() {
+  uint64_t cur = now();
+  // bank별 port 수만큼 조회
+  for (int b = 0; b < m_num_banks; b++) {
+    std::deque<Request>& q = m_bank_queues[b];
+    int served = 0;
+    while (!q.empty() && q.front().ready_cycle <= cur && served < m_ports) {
+      Request req = q.front();
+      q.pop_front();
+      served++;
+      Response resp{req.mf, false, 0, 12};
+      resp.hit = m_banks[b]->lookup(req.mf->get_asid(), req.mf->get_addr(),
+                                    resp.pa, req.mf->get_access_type(),
+                                    &resp.page_shift);
+      if (resp.hit) m_unit_hits[req.unit]++;
+      else m_unit_misses[req.unit]++;
+      // 조회 latency + 돌아가는 crossbar latency
+      m_pending_responses.push_back(PendingResponse{
+          cur + m_hit_latency + m_xbar_latency, req.requester, resp});
+    }
+    // 도착했지만 port가 없어 다음 사이클로 밀린 요청
+    for (auto it = q.begin(); it != q.end() && it->ready_cycle <= cur; ++it)
+      m_port_conflict_cycles++;
+  }
+
+  while (!m_pending_responses.empty() &&
+         m_pending_responses.front().ready_cycle <= cur) {
+    PendingResponse& p = m_pending_responses.front();
+    m_responses[p.requester].push(p.resp);
+    m_pending_responses.pop_front();
+  }
+}
+
+CacheStats SharedTlb::get_stats() const {
+  CacheStats stats;
+  for (TlbArray* bank : m_banks) stats += bank->get_stats();
+  return stats;
+}
+
+void SharedTlb::print_stats(FILE* fp) {
+  get_stats().print_stats(fp, "Shared-TLB");
+  TlbAsidStats asid_stats;
+  for (TlbArray* bank : m_banks) asid_stats += bank->get_asid_stats();
+  if (asid_stats.cross_asid_evictions + asid_stats.flushed_entries)
+    asid_stats.print_stats(fp, "Shared-TLB");
+  fprintf(fp, "shared_tlb_port_conflict_cycles: %lu\n", m_port_conflict_cycles);
+  fprintf(fp, "shared_tlb_queue_full_stalls: %lu\n", m_queue_full_stalls);
+  for (int u = 0; u < m_num_units; u++) {
+    uint64_t total = m_unit_hits[u] + m_unit_misses[u];
+    fprintf(fp, "shared_tlb_unit%d: hits %lu misses %lu hit_rate %.4f\n", u,
+            m_unit_hits[u], m_unit_misses[u],
+            total ? (double)m_unit_hits[u] / total : 0.0);
+  }
+}
+
+}  // namespace NDPSim
+#endif  // TIMING_SIMULATION
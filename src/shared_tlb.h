@@ -0,0 +1,98 @@
+#ifdef TIMING_SIMULATION
+#ifndef SHARED_TLB_H
+#define SHARED_TLB_H
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "cache.h"
+#include "m2ndp_config.h"
+#include "tlb_array.h"
+
+namespace NDPSim {
+
+class Tlb;
+class mem_fetch;
+
+// M2NDP 단위로 NDP unit들이 공유하는 last-level TLB.
+// NDP unit의 private TLB(L1/STLB) miss가 local crossbar를 건너
+// (xbar latency) 4KB VPN으로 interleave된 bank에 도착하고, bank마다
+// 사이클당 처리 가능한 요청 수(port)가 제한된다. hit/miss 결과는 다시
+// crossbar를 건너 요청한 TLB로 돌아가며, miss면 요청 unit이 자신의 MMU로
+// walk한 뒤 fill()로 채운다.
+class SharedTlb {
+ public:
+  SharedTlb(M2NDPConfig* config, int num_units);
+  ~SharedTlb();
+
+  struct Response {
+    mem_fetch* mf;
+    bool hit;
+    uint64_t pa;
+    uint32_t page_shift;
+  };
+
+  // va가 가는 bank의 입력 큐에 자리가 있는지
+  bool can_access(uint64_t va);
+  // unit: M2NDP 내 NDP unit 번호 (hit attribution용)
+  void access(int unit, Tlb* requester, mem_fetch* mf);
+
+  bool has_response(Tlb* requester) const;
+  Response pop_response(Tlb* requester);
+
+  // walk 완료 후 설치. huge page 엔트리는 모든 bank에 복제
+  void fill(int asid, uint64_t va, uint64_t pa, uint32_t page_shift);
+  void flush_asid(int asid);
+  void flush();
+  int invalidate_va(int asid, uint64_t va);
+
+  void cycle();
+  void print_stats(FILE* fp);
+  CacheStats get_stats() const;
+
+ private:
+  struct Request {
+    uint64_t ready_cycle;
+    int unit;
+    Tlb* requester;
+    mem_fetch* mf;
+  };
+  struct PendingResponse {
+    uint64_t ready_cycle;
+    Tlb* requester;
+    Response resp;
+  };
+
+  int bank_of(uint64_t va) const { return (va >> 12) % m_num_banks; }
+  uint64_t now() const { return m_config->get_ndp_cycle(); }
+
+  M2NDPConfig* m_config;
+  int m_num_units;
+  int m_num_banks;
+  int m_ports;
+  int m_hit_latency;
+  int m_xbar_latency;
+  int m_queue_size;
+
+  CacheConfig m_bank_config;
+  std::vector<TlbArray*> m_banks;
+  std::vector<std::deque<Request>> m_bank_queues;
+
+  // 처리 순서대로 완료 cycle이 증가하므로 FIFO
+  std::deque<PendingResponse> m_pending_responses;
+  std::unordered_map<Tlb*, std::queue<Response>> m_responses;
+
+  // 통계: unit별 hit/miss, port 경합으로 대기한 요청-사이클
+  std::vector<uint64_t> m_unit_hits;
+  std::vector<uint64_t> m_unit_misses;
+  uint64_t m_port_conflict_cycles = 0;
+  uint64_t m_queue_full_stalls = 0;
+};
+
+}  // namespace NDPSim
+#endif
+#endif  // TIMING_SIMULATION
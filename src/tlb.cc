@@ -1,18 +1,20 @@
 #ifdef TIMING_SIMULATION
 #include "tlb.h"
 #include "mmu.h"
+#include "shared_tlb.h"
 #include "mem_fetch.h"
 
 namespace NDPSim {
 
 Tlb::Tlb(int id, M2NDPConfig* config, std::string tlb_config,
-         fifo_pipeline<mem_fetch>* to_mem_queue)
+         fifo_pipeline<mem_fetch>* to_mem_queue, int num_l1)
   : m_id(id)
   , m_config(config)
   , m_to_mem_queue(to_mem_queue)
   , m_finished_mf("tlb_finished_mf", 0, m_config->get_request_queue_size())
   , m_tlb_request_queue("tlb_req_queue", true, m_config->get_request_queue_size())
   , m_dram_tlb_latency_queue("dram_tlb_latency_queue", true, m_config->get_request_queue_size())
+  , m_stlb_queue("stlb_queue", true, m_config->get_request_queue_size())
 {
   m_page_size = m_config->get_tlb_page_size();
   // page_shift
@@ -23,18 +25,23 @@ Tlb::Tlb(int id, M2NDPConfig* config, std::string tlb_config,
   m_tlb_config.init(tlb_config, m_config);
   m_tlb = new ReadOnlyCache("tlb", m_tlb_config, id, 0, m_to_mem_queue);
 
+  m_vector_batch     = m_config->is_tlb_vector_batch();
   m_tlb_entry_size   = m_config->get_tlb_entry_size();
   m_tlb_hit_latency  = m_config->get_tlb_hit_latency();
   m_accessed_tlb_addr = m_config->get_accessed_tlb_addr();
 
-  // SW TLB 기본 용량은 1024로 시작 (원한다면 config에서 파생)
-  m_sw_cap = 1024;
+  // L1 TLB 배열: geometry/교체 정책은 tlb_config, latency는 tlb_hit_latency
+  for (int i = 0; i < num_l1; i++) {
+    m_l1.push_back(new TlbArray("l1_tlb", m_tlb_config, m_tlb_hit_latency));
+    m_l1.back()->set_coalesce_pages(std::max(1, m_config->get_tlb_coalesce_pages()));
+  }
 }
 
 void Tlb::set_mmu(MMU* mmu) {
   m_mmu = mmu;
   if (m_mmu) {
-    m_mmu->bind_tlb(this);
+    // 처음 연결한 TLB가 owner (PTW 발행과 MMU tick 담당)
+    if (!m_mmu->get_owner_tlb()) m_mmu->bind_tlb(this);
     m_mmu->bind_config(m_config);
   }
 }
@@ -55,8 +62,11 @@ bool Tlb::data_port_free() { return m_tlb->data_port_free(); }
 bool Tlb::full() { return full(0); }
 
 bool Tlb::full(uint64_t mf_sz) {
-  return (m_tlb_request_queue.size() + m_dram_tlb_latency_queue.size() + mf_sz)
-          >= m_config->get_request_queue_size();
+  return (m_tlb_request_queue.size() + m_dram_tlb_latency_queue.size() +
+          m_stlb_queue.size() + m_shared_miss_queue.size() +
+          m_batched_pending + m_expanded.size() + (m_l1_retry.mf != nullptr) +
+          (m_stlb_retry.mf != nullptr) + mf_sz) >=
+         m_config->get_request_queue_size();
 }
 
 bool Tlb::waiting_for_fill(mem_fetch* mf) {
@@ -76,10 +86,45 @@ void Tlb::fill(mem_fetch* mf) {
 }
 
 void Tlb::access(mem_fetch* mf) {
+  if (m_mmu && m_vector_batch) {
+    BatchKey key = batch_key(mf);
+    auto it = m_batch_leaders.find(key);
+    if (it != m_batch_leaders.end()) {
+      m_batches[it->second].followers.push_back(mf);
+      m_batched_pending++;
+      m_batch_stats.merged++;
+      return;
+    }
+    m_batch_leaders[key] = mf;
+    m_batches[mf].key = key;
+  }
   // TLB hit latency를 모델링: 실제 hit/miss 판단은 bank_access_cycle에서 처리
   m_tlb_request_queue.push(mf, m_tlb_hit_latency);
 }
 
+Tlb::BatchKey Tlb::batch_key(mem_fetch* mf) {
+  return BatchKey(mf->get_asid(), mf->get_addr() >> 12,
+                  mf->get_sub_core_id() % m_l1.size(), needs_dirty(mf),
+                  mf->get_timestamp());
+}
+
+void Tlb::complete_batch(mem_fetch* leader, uint64_t pa) {
+  if (m_batches.empty()) return;
+  auto it = m_batches.find(leader);
+  if (it == m_batches.end()) return;
+  Batch& batch = it->second;
+  m_batch_leaders.erase(batch.key);
+  for (mem_fetch* mf : batch.followers) {
+    uint64_t f_pa = (pa & ~0xFFFULL) | (mf->get_addr() & 0xFFF);
+    mf->set_addr(f_pa);
+    mf->set_channel(m_config->get_channel_index(f_pa));
+    m_expanded.push_back(mf);
+  }
+  m_batched_pending -= batch.followers.size();
+  if (!batch.followers.empty()) m_batch_stats.batches++;
+  m_batches.erase(it);
+}
+
 bool Tlb::data_ready() { return !m_finished_mf.empty(); }
 mem_fetch* Tlb::get_data() { return m_finished_mf.top(); }
 void Tlb::pop_data() { m_finished_mf.pop(); }
@@ -89,9 +134,10 @@ void Tlb::cycle() {
   m_tlb->cycle();
   m_tlb_request_queue.cycle();
   m_dram_tlb_latency_queue.cycle();
+  m_stlb_queue.cycle();
 
-  // MMU tick
-  if (m_mmu) m_mmu->cycle();
+  // MMU tick (DTLB/ITLB가 MMU를 공유하므로 owner TLB만 tick)
+  if (m_mmu && m_mmu->get_owner_tlb() == this) m_mmu->cycle();
 }
 
 bool Tlb::push_mem_req(mem_fetch* mf) {
@@ -110,46 +156,15 @@ void Tlb::bank_access_cycle() {
     m_dram_tlb_latency_queue.pop();
   }
 
-  // 1) MMU 완료분 먼저 회수 → SW TLB에 기록 후 완료 큐로 전달
   if (m_mmu) {
-    while (m_mmu->has_completed() && !m_finished_mf.full()) {
-      MMU::Completed c = m_mmu->pop_completed();
-      // SW TLB에 (vpn -> ppn) 설치
-      sw_tlb_install(vpn(c.va), ppn(c.pa));
-      // 상위로 리턴
-      m_finished_mf.push(c.mf);
-    }
+    hierarchy_access_cycle();
+    return;
   }
 
-  // 2) TLB 요청 처리 (hit latency 경과 후)
+  // MMU가 없으면 기존 캐시 경로로 (원형)
   if (!m_tlb_request_queue.empty() && data_port_free()) {
     mem_fetch* mf = m_tlb_request_queue.top();
     uint64_t va  = mf->get_addr();
-    uint64_t off = page_off(va);
-    uint64_t v   = vpn(va);
-
-    // SW TLB 조회
-    uint64_t pp;
-    if (sw_tlb_lookup(v, pp)) {
-      // hit → PA로 변환, 완료로 전달
-      uint64_t pa = (pp << m_page_shift) | off;
-      mf->set_addr(pa);
-      mf->set_channel(m_config->get_channel_index(pa));
-      if (!m_finished_mf.full()) {
-        m_finished_mf.push(mf);
-        m_tlb_request_queue.pop();
-      }
-      return;
-    }
-
-    // miss → MMU로 비동기 제출
-    if (m_mmu) {
-      m_mmu->submit(mf);
-      m_tlb_request_queue.pop();
-      return;
-    }
-
-    // MMU가 없으면 기존 캐시 경로로 (원형)
     uint64_t tlb_addr = get_tlb_addr(va);
     mem_fetch* tlb_mf = new mem_fetch(
         tlb_addr, TLB_ACC_R, READ_REQUEST, m_tlb_entry_size,
@@ -176,39 +191,195 @@ void Tlb::bank_access_cycle() {
   }
 }
 
-CacheStats Tlb::get_stats() { return m_tlb->get_stats(); }
+void Tlb::hierarchy_access_cycle() {
+  // 0) leader 변환을 받은 batch follower를 완료 큐로
+  while (!m_expanded.empty() && !m_finished_mf.full()) {
+    m_finished_mf.push(m_expanded.front());
+    m_expanded.pop_front();
+  }
 
-uint64_t Tlb::get_tlb_addr(uint64_t addr) {
-  return addr / m_page_size * m_tlb_entry_size + DRAM_TLB_BASE;
-}
+  // 1) MMU 완료분 먼저 회수 → STLB/L1에 설치 후 완료 큐로 전달
+  while (m_mmu->has_completed(this) && !m_finished_mf.full()) {
+    MMU::Completed c = m_mmu->pop_completed(this);
+    int asid = c.mf->get_asid();
+    if (m_shared_tlb) m_shared_tlb->fill(asid, c.va, c.pa, c.page_shift);
+    if (c.coalesce_mask) {
+      // 연속 매핑 run을 한 엔트리로
+      if (m_stlb)
+        m_stlb->install_coalesced(asid, c.va, c.pa, c.coalesce_mask, c.dirty);
+      l1_for(c.mf)->install_coalesced(asid, c.va, c.pa, c.coalesce_mask,
+                                      c.dirty);
+    } else {
+      if (m_stlb) m_stlb->install(asid, c.va, c.pa, c.page_shift, c.dirty);
+      l1_for(c.mf)->install(asid, c.va, c.pa, c.page_shift, c.dirty);
+    }
+    m_finished_mf.push(c.mf);
+    complete_batch(c.mf, c.pa);
+  }
 
-/************** SW TLB (LRU) **************/
+  // 1-1) shared TLB miss → MMU 제출 (walker가 가득이면 다음 사이클 재시도)
+  while (!m_shared_miss_queue.empty() &&
+         m_mmu->submit(m_shared_miss_queue.front(), this)) {
+    m_shared_miss_queue.pop_front();
+  }
 
-void Tlb::sw_tlb_install(uint64_t v, uint64_t p) {
-  auto it = m_sw_map.find(v);
-  if (it != m_sw_map.end()) {
-    m_sw_lru.erase(it->second.second);
-    m_sw_map.erase(it);
+  // 1-2) shared TLB 응답: hit → STLB/L1에 채우고 완료, miss → walk
+  while (m_shared_tlb && m_shared_tlb->has_response(this) &&
+         !m_finished_mf.full()) {
+    SharedTlb::Response r = m_shared_tlb->pop_response(this);
+    if (r.hit) {
+      uint64_t va = r.mf->get_addr();
+      int asid = r.mf->get_asid();
+      if (m_stlb) m_stlb->install(asid, va, r.pa, r.page_shift);
+      l1_for(r.mf)->install(asid, va, r.pa, r.page_shift);
+      finish(r.mf, r.pa);
+    } else {
+      m_shared_miss_queue.push_back(r.mf);
+    }
   }
-  m_sw_lru.push_front(v);
-  m_sw_map[v] = {p, m_sw_lru.begin()};
-  if (m_sw_map.size() > m_sw_cap) {
-    auto victim = m_sw_lru.back();
-    m_sw_lru.pop_back();
-    m_sw_map.erase(victim);
+
+  // 2) L2 STLB 조회 (stlb hit latency 경과 후)
+  if (m_stlb_retry.mf) {
+    retry(m_stlb_retry);
+  } else if (m_stlb && !m_stlb_queue.empty()) {
+    mem_fetch* mf = m_stlb_queue.top();
+    m_stlb_queue.pop();
+    uint64_t va = mf->get_addr();
+    uint64_t pa;
+    uint32_t shift;
+    bool dirty;
+    if (m_stlb->lookup(mf->get_asid(), va, pa, mf->get_access_type(), &shift,
+                       &dirty) &&
+        usable_hit(mf, dirty)) {
+      // hit → L1에 채우고 완료
+      l1_for(mf)->install(mf->get_asid(), va, pa, shift, dirty);
+      forward(m_stlb_retry, mf, true, pa);
+    } else {
+      // miss → shared TLB 또는 MMU로 비동기 제출 (가득이면 다음 사이클 재시도)
+      forward(m_stlb_retry, mf, false, 0);
+    }
+  }
+
+  // 3) L1 TLB 조회 (tlb hit latency 경과 후)
+  if (m_l1_retry.mf) {
+    retry(m_l1_retry);
+  } else if (!m_tlb_request_queue.empty()) {
+    mem_fetch* mf = m_tlb_request_queue.top();
+    m_tlb_request_queue.pop();
+    uint64_t va = mf->get_addr();
+    uint64_t pa;
+    bool dirty;
+    if (l1_for(mf)->lookup(mf->get_asid(), va, pa, mf->get_access_type(),
+                           nullptr, &dirty) &&
+        usable_hit(mf, dirty)) {
+      forward(m_l1_retry, mf, true, pa);
+    } else if (m_stlb) {
+      m_stlb_queue.push(mf, m_stlb->get_hit_latency());
+    } else {
+      forward(m_l1_retry, mf, false, 0);
+    }
   }
 }
 
-bool Tlb::sw_tlb_lookup(uint64_t v, uint64_t& p_out) {
-  auto it = m_sw_map.find(v);
-  if (it == m_sw_map.end()) return false;
-  // LRU update
-  m_sw_lru.erase(it->second.second);
-  m_sw_lru.push_front(v);
-  it->second.second = m_sw_lru.begin();
-  p_out = it->second.first;
+bool Tlb::retry(RetrySlot& slot) {
+  if (!slot.mf) return true;
+  bool done = slot.hit ? finish(slot.mf, slot.pa) : miss_to_next_level(slot.mf);
+  if (done) slot.mf = nullptr;
+  return done;
+}
+
+void Tlb::forward(RetrySlot& slot, mem_fetch* mf, bool hit, uint64_t pa) {
+  slot.mf = mf;
+  slot.hit = hit;
+  slot.pa = pa;
+  retry(slot);
+}
+
+bool Tlb::miss_to_next_level(mem_fetch* mf) {
+  // shared TLB는 D 비트를 모르므로 dirty가 필요한 store는 바로 walk
+  if (!m_shared_tlb || needs_dirty(mf)) return m_mmu->submit(mf, this);
+  if (!m_shared_tlb->can_access(mf->get_addr())) return false;
+  m_shared_tlb->access(m_unit, this, mf);
   return true;
 }
 
+bool Tlb::needs_dirty(mem_fetch* mf) const {
+  return m_mmu->ad_update_enabled() && MMU::is_write_access(mf);
+}
+
+bool Tlb::usable_hit(mem_fetch* mf, bool dirty) {
+  if (dirty || !needs_dirty(mf)) return true;
+  m_mmu->count_clean_write_hit();
+  return false;
+}
+
+TlbArray* Tlb::l1_for(mem_fetch* mf) {
+  // sub-core id가 없는 요청(cache가 만든 write-allocate 등)은 0번 배열로
+  return m_l1[mf->get_sub_core_id() % m_l1.size()];
+}
+
+bool Tlb::finish(mem_fetch* mf, uint64_t pa) {
+  if (m_finished_mf.full()) return false;
+  mf->set_addr(pa);
+  mf->set_channel(m_config->get_channel_index(pa));
+  m_finished_mf.push(mf);
+  complete_batch(mf, pa);
+  return true;
+}
+
+CacheStats Tlb::get_stats() {
+  // MMU 경로에서는 L1 TLB 배열들의 통계, 아니면 원래 cache형 TLB 통계
+  if (!m_mmu) return m_tlb->get_stats();
+  CacheStats stats;
+  for (TlbArray* l1 : m_l1) stats += l1->get_stats();
+  return stats;
+}
+
+bool Tlb::is_resident(int asid, uint64_t va) const {
+  // MMU가 없으면 (cache형 TLB / ideal) 번역 비용을 구분하지 않음
+  if (!m_mmu || m_ideal_tlb) return true;
+  for (TlbArray* l1 : m_l1)
+    if (l1->probe(asid, va)) return true;
+  return m_stlb && m_stlb->probe(asid, va);
+}
+
+bool Tlb::is_walk_pending(int asid, uint64_t va) const {
+  return m_mmu && m_mmu->is_walk_pending(asid, va);
+}
+
+void Tlb::flush_asid(int asid) {
+  for (TlbArray* l1 : m_l1) l1->flush_asid(asid);
+}
+
+void Tlb::flush() {
+  for (TlbArray* l1 : m_l1) l1->flush();
+}
+
+int Tlb::invalidate_va(int asid, uint64_t va) {
+  int count = 0;
+  for (TlbArray* l1 : m_l1) count += l1->invalidate_va(asid, va);
+  return count;
+}
+
+bool Tlb::is_walker_saturated() const {
+  return m_mmu && m_mmu->is_saturated();
+}
+
+TlbCoalesceStats Tlb::get_coalesce_stats() {
+  TlbCoalesceStats stats;
+  for (TlbArray* l1 : m_l1) stats += l1->get_coalesce_stats();
+  return stats;
+}
+
+TlbAsidStats Tlb::get_asid_stats() {
+  TlbAsidStats stats;
+  for (TlbArray* l1 : m_l1) stats += l1->get_asid_stats();
+  return stats;
+}
+
+uint64_t Tlb::get_tlb_addr(uint64_t addr) {
+  return addr / m_page_size * m_tlb_entry_size + DRAM_TLB_BASE;
+}
+
 } // namespace NDPSim
 #endif // TIMING_SIMULATION
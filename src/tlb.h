@@ -2,29 +2,45 @@
 #ifndef TLB_H
 #define TLB_H
 
+#include <deque>
+#include <map>
+#include <tuple>
 #include <unordered_map>
-#include <list>
+#include <vector>
 #include "cache.h"
 #include "common.h"
 #include "delay_queue.h"
 #include "m2ndp_config.h"
+#include "tlb_array.h"
 
 namespace NDPSim {
 
 class MMU;
+class SharedTlb;
 class mem_fetch;
 template <typename T> class fifo_pipeline;
 
 class Tlb {
 public:
+  // num_l1: L1 TLB 배열 개수 (DTLB는 sub-core 수, ITLB는 1)
   Tlb(int id, M2NDPConfig *config, std::string tlb_config,
-      fifo_pipeline<mem_fetch> *to_mem_queue);
+      fifo_pipeline<mem_fetch> *to_mem_queue, int num_l1 = 1);
 
   void set_ideal_tlb();
 
   // MMU 주입 & 바인딩
   void set_mmu(MMU* mmu);
 
+  // NdpUnit 단위로 공유하는 L2 STLB (nullptr이면 L1 miss가 바로 MMU로)
+  void set_stlb(TlbArray* stlb) { m_stlb = stlb; }
+
+  // M2NDP 단위 공유 last-level TLB (nullptr이면 private miss가 바로 MMU로)
+  // unit: M2NDP 내 NDP unit 번호 (shared TLB의 unit별 hit 집계)
+  void set_shared_tlb(SharedTlb* llt, int unit) {
+    m_shared_tlb = llt;
+    m_unit = unit;
+  }
+
   bool fill_port_free();
   bool data_port_free();
   bool full();
@@ -35,7 +51,9 @@ public:
 
   bool waiting_for_fill(mem_fetch *mf);
 
-  // 상위 요청
+  // 상위 요청. vector batching이 켜져 있으면 같은 vector 요청(같은 cycle에
+  // 만든 같은 sub-core 요청)의 같은 4KB 페이지 요청은 첫 요청만 변환하고
+  // 나머지는 그 결과를 페이지 오프셋만 바꿔 받음
   void access(mem_fetch* mf);
 
   // 완료 데이터
@@ -51,22 +69,67 @@ public:
   bool push_mem_req(mem_fetch* mf);
 
   CacheStats get_stats();
+  TlbCoalesceStats get_coalesce_stats();
+  TlbAsidStats get_asid_stats();
+  TlbBatchStats get_batch_stats() const { return m_batch_stats; }
+
+  // L1 배열에서 asid의 엔트리만 / 전부 무효화 (STLB는 NdpUnit이 처리)
+  void flush_asid(int asid);
+  void flush();
+  // L1 배열에서 va를 덮는 엔트리 무효화 (shootdown), 무효화한 수 반환
+  int invalidate_va(int asid, uint64_t va);
+
+  // uthread 스케줄링용: va가 (어느 sub-core의) L1 또는 STLB에 있는지,
+  // 같은 페이지의 walk가 진행 중인지, walker가 포화됐는지 (통계 변화 없음)
+  bool is_resident(int asid, uint64_t va) const;
+  bool is_walk_pending(int asid, uint64_t va) const;
+  bool is_walker_saturated() const;
 
 private:
   uint64_t get_tlb_addr(uint64_t addr);
 
-  inline uint64_t vpn(uint64_t va) const { return va >> m_page_shift; }
-  inline uint64_t ppn(uint64_t pa) const { return pa >> m_page_shift; }
-  inline uint64_t page_off(uint64_t a) const { return a & (m_page_size - 1); }
-
-  // 간단한 SW TLB (LRU)
-  void sw_tlb_install(uint64_t vpn, uint64_t ppn);
-  bool sw_tlb_lookup(uint64_t vpn, uint64_t& ppn_out);
+  // mf를 보낸 sub-core의 L1 배열
+  TlbArray* l1_for(mem_fetch* mf);
+
+  // PA로 교체 후 완료 큐로 전달 (완료 큐가 풀이면 false)
+  bool finish(mem_fetch* mf, uint64_t pa);
+
+  // 이미 조회를 마쳤지만 다음 단계(완료 큐 / shared TLB·MMU)가 받지 못한 요청.
+  // 슬롯이 차 있는 동안 그 단계는 새 조회 대신 재전달만 시도하므로
+  // lookup 통계와 LRU는 요청당 한 번만 갱신된다.
+  struct RetrySlot {
+    mem_fetch* mf = nullptr;
+    bool hit = false;
+    uint64_t pa = 0;
+  };
+  // 슬롯의 요청 재전달, 슬롯이 비면 true
+  bool retry(RetrySlot& slot);
+  // 조회 결과를 다음 단계로 전달, 받아주지 않으면 슬롯에 보관
+  void forward(RetrySlot& slot, mem_fetch* mf, bool hit, uint64_t pa);
+
+  // L1 → L2 STLB → (shared TLB) → MMU 경로 (MMU가 있을 때)
+  void hierarchy_access_cycle();
+
+  // private TLB miss를 다음 단계(shared TLB 또는 MMU)로. 받아주지 않으면 false
+  bool miss_to_next_level(mem_fetch* mf);
+
+  // A/D 모델링에서 store는 dirty 엔트리만 쓸 수 있음 (clean이면 다시 walk)
+  bool needs_dirty(mem_fetch* mf) const;
+  // L1/STLB lookup hit이 그대로 쓸 수 있는 hit인지 (clean store hit 집계)
+  bool usable_hit(mem_fetch* mf, bool dirty);
+
+  // vector batch: (ASID, 4KB VPN, L1 배열, dirty 필요 여부, 요청 timestamp)
+  using BatchKey = std::tuple<int, uint64_t, uint32_t, bool, uint64_t>;
+  BatchKey batch_key(mem_fetch* mf);
+  // leader가 PA를 받으면 follower들도 같은 페이지로 완료
+  void complete_batch(mem_fetch* leader, uint64_t pa);
 
 private:
   MMU* m_mmu = nullptr;
 
   int  m_id;
+  // config page_size: MMU 없이 쓰는 원래 cache형(DRAM) TLB 경로의 단위.
+  // MMU 경로는 walk가 알려주는 leaf 크기를 그대로 사용한다.
   int  m_page_size;
   int  m_tlb_entry_size;
   int  m_tlb_hit_latency;
@@ -94,11 +157,34 @@ private:
   CacheConfig m_tlb_config;
   Cache *m_tlb;
 
-  // SW TLB: vpn -> (ppn, LRU iterator)
-  size_t m_sw_cap = 1024; // 필요 시 config에서 유도 가능
-  std::list<uint64_t> m_sw_lru; // MRU front
-  std::unordered_map<uint64_t,
-    std::pair<uint64_t, std::list<uint64_t>::iterator>> m_sw_map;
+  // L1 TLB: sub-core별 배열 (geometry는 tlb_config에서)
+  std::vector<TlbArray*> m_l1;
+
+  // L2 STLB (NdpUnit 소유, 공유) 와 그 hit latency 모델
+  TlbArray* m_stlb = nullptr;
+  DelayQueue<mem_fetch*> m_stlb_queue;
+
+  // L1 / STLB 조회 단계별 재전달 슬롯
+  RetrySlot m_l1_retry;
+  RetrySlot m_stlb_retry;
+
+  // M2NDP 공유 TLB와, 거기서 miss 나서 MMU 제출을 기다리는 요청
+  SharedTlb* m_shared_tlb = nullptr;
+  int m_unit = 0;
+  std::deque<mem_fetch*> m_shared_miss_queue;
+
+  // vector batching: 진행 중인 leader와 그 follower, 완료 큐를 기다리는
+  // follower (follower는 TLB port를 쓰지 않지만 request queue 자리는 차지)
+  struct Batch {
+    BatchKey key;
+    std::vector<mem_fetch*> followers;
+  };
+  bool m_vector_batch = false;
+  std::map<BatchKey, mem_fetch*> m_batch_leaders;
+  std::unordered_map<mem_fetch*, Batch> m_batches;
+  std::deque<mem_fetch*> m_expanded;
+  int m_batched_pending = 0;
+  TlbBatchStats m_batch_stats;
 };
 
 } // namespace NDPSim
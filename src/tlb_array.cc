@@ -0,0 +1,201 @@
+#ifdef TIMING_SIMULATION
+#include "tlb_array.h"
+
+#include <algorithm>
+
+namespace NDPSim {
+
+constexpr uint32_t TlbArray::PAGE_SHIFTS[];
+
+TlbArray::TlbArray(std::string name, const CacheConfig& config,
+                   int hit_latency)
+  : m_name(name)
+  , m_nset(config.get_num_sets())
+  , m_assoc(config.get_num_assoc())
+  , m_policy(config.get_evict_policy())
+  , m_hit_latency(hit_latency)
+{
+  assert(m_nset > 0 && m_assoc > 0);
+  uint32_t entries = m_nset * m_assoc;
+  m_vpns.assign(entries, 0);
+  m_ppns.assign(entries, 0);
+  m_masks.assign(entries, 0);
+  m_dirty.assign(entries, 0);
+  m_stamps.assign(entries, 0);
+  m_shifts.assign(entries, 0);
+  m_asids.assign(entries, 0);
+  m_valid.assign(entries, 0);
+}
+
+int TlbArray::size_class(uint32_t page_shift) const {
+  for (int i = 0; i < NUM_PAGE_SIZES; i++)
+    if (PAGE_SHIFTS[i] == page_shift) return i;
+  assert(0);
+  return 0;
+}
+
+void TlbArray::set_coalesce_pages(int pages) {
+  uint32_t bits = 0;
+  while ((1 << bits) < pages) bits++;
+  assert(pages >= 1 && (1 << bits) == pages && bits <= 6);
+  m_group_bits = bits;
+  flush();
+}
+
+int TlbArray::find(int asid, uint64_t va, uint32_t& shift_out) const {
+  // 작은 페이지부터 조회 (4KB → 2MB → 1GB)
+  for (int c = 0; c < NUM_PAGE_SIZES; c++) {
+    if (m_size_count[c] == 0) continue;
+    uint32_t shift = PAGE_SHIFTS[c];
+    uint32_t kshift = key_shift(shift);
+    uint64_t v = va >> kshift;
+    uint64_t bit = slot_bit(va, shift);
+    uint32_t base = set_index(va, kshift) * m_assoc;
+    for (uint32_t way = 0; way < m_assoc; way++) {
+      uint32_t i = base + way;
+      if (m_valid[i] && m_asids[i] == asid && m_shifts[i] == shift &&
+          m_vpns[i] == v && (m_masks[i] & bit)) {
+        shift_out = shift;
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
+bool TlbArray::lookup(int asid, uint64_t va, uint64_t& pa_out,
+                      int access_type, uint32_t* shift_out, bool* dirty_out) {
+  m_clock++;
+  uint32_t shift;
+  int i = find(asid, va, shift);
+  if (i < 0) {
+    m_stats.inc_stats(access_type, MISS);
+    return false;
+  }
+  if (m_policy == LRU) m_stamps[i] = m_clock;
+  // 그룹 엔트리: slot 0 기준 PPN + slot 번호
+  uint32_t kshift = key_shift(shift);
+  uint64_t ppn = m_ppns[i] + ((va >> shift) - (m_vpns[i] << (kshift - shift)));
+  pa_out = (ppn << shift) | (va & ((1ULL << shift) - 1));
+  if (shift_out) *shift_out = shift;
+  if (dirty_out) *dirty_out = (m_dirty[i] & slot_bit(va, shift)) != 0;
+  if (m_masks[i] & (m_masks[i] - 1)) m_coalesce_stats.coalesced_hits++;
+  m_stats.inc_stats(access_type, HIT);
+  return true;
+}
+
+bool TlbArray::probe(int asid, uint64_t va) const {
+  uint32_t shift;
+  return find(asid, va, shift) >= 0;
+}
+
+void TlbArray::install(int asid, uint64_t va, uint64_t pa,
+                       uint32_t page_shift, bool dirty) {
+  uint64_t bit = slot_bit(va, page_shift);
+  install_entry(asid, va, pa, page_shift, bit, dirty ? bit : 0);
+}
+
+void TlbArray::install_coalesced(int asid, uint64_t va, uint64_t pa,
+                                 uint64_t group_mask, bool dirty) {
+  uint64_t bit = slot_bit(va, 12);
+  // 그룹 크기보다 넓은 mask는 잘라냄
+  if (m_group_bits < 6) group_mask &= (1ULL << (1 << m_group_bits)) - 1;
+  install_entry(asid, va, pa, 12, group_mask | bit, dirty ? bit : 0);
+}
+
+void TlbArray::install_entry(int asid, uint64_t va, uint64_t pa,
+                             uint32_t page_shift, uint64_t mask,
+                             uint64_t dirty_mask) {
+  m_clock++;
+  uint32_t kshift = key_shift(page_shift);
+  uint64_t v = va >> kshift;
+  // slot 0 기준 PPN (같은 그룹의 연속 매핑은 같은 값)
+  uint64_t ppn = (pa >> page_shift) - ((va >> page_shift) - (v << (kshift - page_shift)));
+  uint32_t base = set_index(va, kshift) * m_assoc;
+  int victim = -1;
+  // 이미 있으면 갱신(bitmap 합침), 없으면 invalid 우선, 그 다음 stamp가 가장 오래된 것
+  for (uint32_t way = 0; way < m_assoc; way++) {
+    uint32_t i = base + way;
+    if (m_valid[i] && m_asids[i] == asid && m_shifts[i] == page_shift &&
+        m_vpns[i] == v && (m_ppns[i] == ppn || (m_masks[i] & mask))) {
+      if (m_ppns[i] != ppn) {  // 매핑이 바뀐 경우
+        m_masks[i] = 0;
+        m_dirty[i] = 0;
+      }
+      m_ppns[i] = ppn;
+      m_masks[i] |= mask;
+      m_dirty[i] |= dirty_mask;
+      if (m_policy == LRU) m_stamps[i] = m_clock;
+      count_coalesced(m_masks[i]);
+      return;
+    }
+  }
+  for (uint32_t way = 0; way < m_assoc; way++) {
+    uint32_t i = base + way;
+    if (!m_valid[i]) { victim = i; break; }
+    if (victim < 0 || m_stamps[i] < m_stamps[victim]) victim = i;
+  }
+  if (m_valid[victim]) {
+    m_size_count[size_class(m_shifts[victim])]--;
+    if (m_asids[victim] != asid) m_asid_stats.cross_asid_evictions++;
+  }
+  m_valid[victim]  = 1;
+  m_asids[victim]  = asid;
+  m_vpns[victim]   = v;
+  m_ppns[victim]   = ppn;
+  m_masks[victim]  = mask;
+  m_dirty[victim]  = dirty_mask;
+  m_shifts[victim] = page_shift;
+  m_stamps[victim] = m_clock;
+  m_size_count[size_class(page_shift)]++;
+  count_coalesced(mask);
+}
+
+void TlbArray::count_coalesced(uint64_t mask) {
+  uint64_t pages = __builtin_popcountll(mask);
+  if (pages < 2) return;
+  m_coalesce_stats.installs++;
+  m_coalesce_stats.covered_pages += pages;
+  m_coalesce_stats.max_coverage =
+      std::max(m_coalesce_stats.max_coverage, pages);
+}
+
+void TlbArray::invalidate(uint32_t i) {
+  m_valid[i] = 0;
+  m_size_count[size_class(m_shifts[i])]--;
+  m_asid_stats.flushed_entries++;
+}
+
+void TlbArray::flush() {
+  for (uint32_t i = 0; i < m_valid.size(); i++)
+    if (m_valid[i]) invalidate(i);
+}
+
+void TlbArray::flush_asid(int asid) {
+  for (uint32_t i = 0; i < m_valid.size(); i++)
+    if (m_valid[i] && m_asids[i] == asid) invalidate(i);
+}
+
+int TlbArray::invalidate_va(int asid, uint64_t va) {
+  int count = 0;
+  for (int c = 0; c < NUM_PAGE_SIZES; c++) {
+    if (m_size_count[c] == 0) continue;
+    uint32_t shift = PAGE_SHIFTS[c];
+    uint32_t kshift = key_shift(shift);
+    uint64_t v = va >> kshift;
+    uint64_t bit = slot_bit(va, shift);
+    uint32_t base = set_index(va, kshift) * m_assoc;
+    for (uint32_t way = 0; way < m_assoc; way++) {
+      uint32_t i = base + way;
+      if (m_valid[i] && (asid < 0 || m_asids[i] == asid) &&
+          m_shifts[i] == shift && m_vpns[i] == v && (m_masks[i] & bit)) {
+        invalidate(i);
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+}  // namespace NDPSim
+#endif  // TIMING_SIMULATION
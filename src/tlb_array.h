@@ -0,0 +1,108 @@
+#ifdef TIMING_SIMULATION
+#ifndef TLB_ARRAY_H
+#define TLB_ARRAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cache.h"
+#include "cache_stats.h"
+#include "tlb_stats.h"
+
+namespace NDPSim {
+
+// set-associative 변환 배열 (L1 DTLB / L2 STLB 공용).
+// 엔트리는 flat한 배열(struct-of-arrays)로 보관하고, 4KB/2MB/1GB 엔트리를
+// 한 배열에 섞어서 저장한다. set index는 해당 page 크기의 VPN으로 계산.
+// coalescing을 켜면 4KB 엔트리는 정렬된 N페이지 그룹 단위로 저장되고,
+// 그룹 안에서 PPN이 연속인 페이지들을 bitmap 하나로 함께 덮는다 (CoLT).
+// 엔트리는 ASID로 태그되어 여러 address space가 한 배열을 나눠 쓴다
+// (set index는 VA만으로 계산, flush_asid()로 해당 ASID만 무효화).
+class TlbArray {
+public:
+  // geometry(set 수, assoc, 교체 정책)는 cache config 문자열에서 가져옴
+  TlbArray(std::string name, const CacheConfig& config, int hit_latency);
+
+  // hit이면 PA(와 선택적으로 leaf page shift, 페이지 dirty 여부)를 돌려줌
+  bool lookup(int asid, uint64_t va, uint64_t& pa_out, int access_type,
+              uint32_t* shift_out = nullptr, bool* dirty_out = nullptr);
+  // 통계/교체 상태를 건드리지 않고 va의 엔트리가 있는지만 확인
+  bool probe(int asid, uint64_t va) const;
+  // dirty: leaf PTE의 D 비트 (A/D 모델링에서 clean 페이지 store 판단용)
+  void install(int asid, uint64_t va, uint64_t pa, uint32_t page_shift,
+               bool dirty = false);
+  // 4KB 페이지 va→pa와 같은 그룹에서 연속 매핑인 페이지들(slot bitmap)을
+  // 한 엔트리로 설치. coalescing이 꺼져 있으면 install()과 같음.
+  // dirty는 va 페이지에만 적용 (그룹의 다른 PTE D 비트는 모름)
+  void install_coalesced(int asid, uint64_t va, uint64_t pa,
+                         uint64_t group_mask, bool dirty = false);
+
+  // 4KB 엔트리 그룹 크기 (페이지 수, 2의 거듭제곱 ≤ 64, 1이면 끔)
+  void set_coalesce_pages(int pages);
+  int get_coalesce_pages() const { return 1 << m_group_bits; }
+  void flush();
+  // asid의 엔트리만 무효화
+  void flush_asid(int asid);
+  // va를 덮는 엔트리 무효화 (asid < 0이면 모든 ASID), 무효화한 수 반환.
+  // coalesced 엔트리는 그룹 전체를 지움
+  int invalidate_va(int asid, uint64_t va);
+
+  int get_hit_latency() const { return m_hit_latency; }
+  int get_num_entries() const { return m_nset * m_assoc; }
+  const std::string& get_name() const { return m_name; }
+  CacheStats get_stats() const { return m_stats; }
+  TlbCoalesceStats get_coalesce_stats() const { return m_coalesce_stats; }
+  TlbAsidStats get_asid_stats() const { return m_asid_stats; }
+
+private:
+  static constexpr int NUM_PAGE_SIZES = 3;  // 4KB, 2MB, 1GB
+  static constexpr uint32_t PAGE_SHIFTS[NUM_PAGE_SIZES] = {12, 21, 30};
+
+  int size_class(uint32_t page_shift) const;
+  // va를 덮는 엔트리 index (없으면 -1)와 그 page shift
+  int find(int asid, uint64_t va, uint32_t& shift_out) const;
+  inline uint32_t set_index(uint64_t va, uint32_t shift) const {
+    return (va >> shift) % m_nset;
+  }
+  // 엔트리 tag에 쓰는 shift (4KB는 그룹 단위)
+  inline uint32_t key_shift(uint32_t page_shift) const {
+    return page_shift == 12 ? 12 + m_group_bits : page_shift;
+  }
+  inline uint64_t slot_bit(uint64_t va, uint32_t page_shift) const {
+    return page_shift == 12 ? 1ULL << ((va >> 12) & ((1ULL << m_group_bits) - 1))
+                            : 1ULL;
+  }
+  void install_entry(int asid, uint64_t va, uint64_t pa, uint32_t page_shift,
+                     uint64_t mask, uint64_t dirty_mask);
+  void invalidate(uint32_t i);
+  void count_coalesced(uint64_t mask);
+
+  std::string m_name;
+  uint32_t m_nset;
+  uint32_t m_assoc;
+  EvictPolicy m_policy;
+  int m_hit_latency;
+  uint64_t m_clock = 0;
+
+  std::vector<uint64_t> m_vpns;
+  std::vector<uint64_t> m_ppns;   // 4KB 그룹 엔트리는 slot 0 기준 PPN
+  std::vector<uint64_t> m_masks;  // 그룹 내 유효 slot bitmap (huge page는 1)
+  std::vector<uint64_t> m_dirty;  // 그 중 D 비트가 켜진 slot
+  std::vector<uint64_t> m_stamps;  // LRU: 마지막 사용, FIFO: 설치 시각
+  std::vector<uint8_t>  m_shifts;
+  std::vector<uint16_t> m_asids;
+  std::vector<uint8_t>  m_valid;
+
+  // page 크기별 유효 엔트리 수 (없는 크기는 조회 생략)
+  uint64_t m_size_count[NUM_PAGE_SIZES] = {0, 0, 0};
+
+  uint32_t m_group_bits = 0;
+
+  CacheStats m_stats;
+  TlbCoalesceStats m_coalesce_stats;
+  TlbAsidStats m_asid_stats;
+};
+
+}  // namespace NDPSim
+#endif
+#endif  // TIMING_SIMULATION
@@ -0,0 +1,358 @@
+#ifdef TIMING_SIMULATION
+#ifndef TLB_STATS_H
+#define TLB_STATS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace NDPSim {
+
+// coalesced(CoLT형) TLB 엔트리 통계
+struct TlbCoalesceStats {
+  uint64_t installs = 0;        // 2페이지 이상을 덮는 엔트리 설치 수
+  uint64_t covered_pages = 0;   // 그 엔트리들이 덮는 4KB 페이지 수 합
+  uint64_t max_coverage = 0;    // 한 엔트리가 덮은 최대 페이지 수
+  uint64_t coalesced_hits = 0;  // 2페이지 이상 엔트리에서 난 hit
+
+  TlbCoalesceStats& operator+=(const TlbCoalesceStats& other) {
+    installs += other.installs;
+    covered_pages += other.covered_pages;
+    max_coverage = std::max(max_coverage, other.max_coverage);
+    coalesced_hits += other.coalesced_hits;
+    return *this;
+  }
+  void print_stats(FILE* out, const char* name) const {
+    fprintf(out, "%s coalesced installs: %lu\n", name, installs);
+    fprintf(out, "%s coalesced hits: %lu\n", name, coalesced_hits);
+    fprintf(out, "%s avg pages per coalesced entry: %.2f (max %lu)\n", name,
+            installs ? (double)covered_pages / installs : 0.0, max_coverage);
+  }
+};
+
+// vector 요청 batching: 같은 페이지 요청을 leader 하나로 변환한 batch 수,
+// lookup 없이 leader의 변환을 받은 요청 수
+struct TlbBatchStats {
+  uint64_t batches = 0;
+  uint64_t merged = 0;
+
+  TlbBatchStats& operator+=(const TlbBatchStats& other) {
+    batches += other.batches;
+    merged += other.merged;
+    return *this;
+  }
+  void print_stats(FILE* out, const char* name) const {
+    fprintf(out, "%s vector batches: %lu (merged requests %lu)\n", name,
+            batches, merged);
+  }
+};
+
+// ASID(address space) 태그 통계: 다른 ASID 엔트리를 밀어낸 설치 수
+// (tenant 간 간섭), flush로 무효화한 엔트리 수
+struct TlbAsidStats {
+  uint64_t cross_asid_evictions = 0;
+  uint64_t flushed_entries = 0;
+
+  TlbAsidStats& operator+=(const TlbAsidStats& other) {
+    cross_asid_evictions += other.cross_asid_evictions;
+    flushed_entries += other.flushed_entries;
+    return *this;
+  }
+  void print_stats(FILE* out, const char* name) const {
+    fprintf(out, "%s cross-ASID evictions: %lu\n", name, cross_asid_evictions);
+    fprintf(out, "%s flushed entries: %lu\n", name, flushed_entries);
+  }
+};
+
+// log2 구간 히스토그램: bucket 0 = 0, bucket i = [2^(i-1), 2^i)
+struct LatencyHistogram {
+  static constexpr int NUM_BUCKETS = 24;
+  uint64_t buckets[NUM_BUCKETS] = {};
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  void add(uint64_t v) {
+    int b = v ? 64 - __builtin_clzll(v) : 0;
+    buckets[std::min(b, NUM_BUCKETS - 1)]++;
+    count++;
+    sum += v;
+    max = std::max(max, v);
+  }
+  double avg() const { return count ? (double)sum / count : 0.0; }
+
+  LatencyHistogram& operator+=(const LatencyHistogram& other) {
+    for (int i = 0; i < NUM_BUCKETS; i++) buckets[i] += other.buckets[i];
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+    return *this;
+  }
+  void print_stats(FILE* out, const char* name) const {
+    fprintf(out, "%s: count %lu avg %.2f max %lu\n", name, count, avg(), max);
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+      if (!buckets[i]) continue;
+      uint64_t lo = i ? 1ULL << (i - 1) : 0;
+      uint64_t hi = 1ULL << i;
+      fprintf(out, "\t[%lu, %lu%s: %lu (%.2f %%)\n", lo, hi,
+              i == NUM_BUCKETS - 1 ? "+)" : ")", buckets[i],
+              (double)buckets[i] / count * 100);
+    }
+  }
+};
+
+// MMU page-table walker 통계
+struct WalkStats {
+  uint64_t walks=0, walk_reads=0, hits=0, fails=0;
+  // 실제 MemoryMap 조회 수 (batch 내 PTE 라인 재사용 후)
+  uint64_t functional_loads=0;
+  // 같은 VPN의 in-flight walk에 합쳐진 요청 수 (walk MSHR)
+  uint64_t walk_merges=0;
+  // walker pool: 점유율(busy walker 누적), 대기 큐 길이/지연, backpressure
+  uint64_t cycles=0, busy_walker_cycles=0, pending_walk_cycles=0;
+  uint64_t max_pending_walks=0, submit_stalls=0;
+  uint64_t queue_delay_sum=0, max_queue_delay=0;
+  // leaf 페이지 크기별 완료 walk 수
+  uint64_t leaf_4k=0, leaf_2m=0, leaf_1g=0;
+  // page-walk cache 레벨별 hit/miss
+  uint64_t pml4e_pwc_hits=0, pml4e_pwc_misses=0;
+  uint64_t pdpte_pwc_hits=0, pdpte_pwc_misses=0;
+  uint64_t pde_pwc_hits=0,   pde_pwc_misses=0;
+  // demand paging: host로 보낸 fault 수, replay 수, fault 왕복 지연 합
+  uint64_t page_faults=0, fault_replays=0, fault_latency_sum=0;
+  // ATS 모드: ATC hit/miss, host로 보낸 ATS 요청과 왕복 지연 합
+  uint64_t atc_hits=0, atc_misses=0, ats_requests=0, ats_latency_sum=0;
+  // coalescing: 연속 매핑을 찾은 walk, 덮은 페이지 수, 추가로 본 PTE 라인
+  uint64_t coalesced_walks=0, coalesced_pages=0, coalesce_extra_lines=0;
+  // prefetcher: 발행/throttle로 생략, buffer hit(useful), 진행 중 prefetch에
+  // 합쳐진 demand(late), 쓰이지 않고 밀려난 엔트리 (accuracy/coverage용)
+  uint64_t demand_misses=0;
+  uint64_t prefetch_issued=0, prefetch_throttled=0, prefetch_useful=0;
+  uint64_t prefetch_late=0, prefetch_unused_evictions=0;
+  // A/D bit: leaf PTE에 보낸 locked RMW 수, 새로 켠 A/D 비트 수, RMW 왕복
+  // 지연 합, dirty가 아닌 TLB 엔트리에 store가 hit해서 다시 walk한 수
+  uint64_t ad_updates=0, ad_accessed=0, ad_dirty=0, ad_latency_sum=0;
+  uint64_t clean_write_hits=0;
+  // nested(2D) walk: guest PTE / stage-2 PTE read 수, nested TLB와 stage-2
+  // PWC hit/miss, stage-2 not-present로 실패한 walk
+  uint64_t nested_walks=0, guest_walk_reads=0, host_walk_reads=0;
+  uint64_t nested_tlb_hits=0, nested_tlb_misses=0;
+  uint64_t s2_pwc_hits=0, s2_pwc_misses=0, s2_faults=0;
+  // demand walk 지연 (제출 → 완료). queue는 walker를 기다린 시간,
+  // memory는 walker를 잡고 PTE를 읽은 시간 (fault 처리 시간은 둘 다 아님)
+  LatencyHistogram walk_latency;
+  LatencyHistogram queue_latency;
+  LatencyHistogram memory_latency;
+  // 완료된 walk당 PTE 라인 read 수 (마지막 칸은 그 이상, nested는 최대 24)
+  static constexpr int MAX_READS_PER_WALK = 24;
+  uint64_t reads_per_walk[MAX_READS_PER_WALK + 1] = {};
+  // DRAM 채널별 PTE 라인 read 수와 (발행 → fill) 지연 합 (PTW hotspot 확인용)
+  std::vector<uint64_t> channel_reads;
+  std::vector<uint64_t> channel_latency_sum;
+
+  void add_channel_read(int channel, uint64_t latency) {
+    if ((size_t)channel >= channel_reads.size()) {
+      channel_reads.resize(channel + 1, 0);
+      channel_latency_sum.resize(channel + 1, 0);
+    }
+    channel_reads[channel]++;
+    channel_latency_sum[channel] += latency;
+  }
+
+  WalkStats& operator+=(const WalkStats& o) {
+    walks += o.walks; walk_reads += o.walk_reads;
+    hits += o.hits; fails += o.fails;
+    functional_loads += o.functional_loads;
+    walk_merges += o.walk_merges;
+    cycles += o.cycles;
+    busy_walker_cycles += o.busy_walker_cycles;
+    pending_walk_cycles += o.pending_walk_cycles;
+    max_pending_walks = std::max(max_pending_walks, o.max_pending_walks);
+    submit_stalls += o.submit_stalls;
+    queue_delay_sum += o.queue_delay_sum;
+    max_queue_delay = std::max(max_queue_delay, o.max_queue_delay);
+    leaf_4k += o.leaf_4k; leaf_2m += o.leaf_2m; leaf_1g += o.leaf_1g;
+    pml4e_pwc_hits += o.pml4e_pwc_hits; pml4e_pwc_misses += o.pml4e_pwc_misses;
+    pdpte_pwc_hits += o.pdpte_pwc_hits; pdpte_pwc_misses += o.pdpte_pwc_misses;
+    pde_pwc_hits += o.pde_pwc_hits;     pde_pwc_misses += o.pde_pwc_misses;
+    page_faults += o.page_faults; fault_replays += o.fault_replays;
+    fault_latency_sum += o.fault_latency_sum;
+    atc_hits += o.atc_hits; atc_misses += o.atc_misses;
+    ats_requests += o.ats_requests; ats_latency_sum += o.ats_latency_sum;
+    coalesced_walks += o.coalesced_walks;
+    coalesced_pages += o.coalesced_pages;
+    coalesce_extra_lines += o.coalesce_extra_lines;
+    demand_misses += o.demand_misses;
+    prefetch_issued += o.prefetch_issued;
+    prefetch_throttled += o.prefetch_throttled;
+    prefetch_useful += o.prefetch_useful;
+    prefetch_late += o.prefetch_late;
+    prefetch_unused_evictions += o.prefetch_unused_evictions;
+    ad_updates += o.ad_updates; ad_accessed += o.ad_accessed;
+    ad_dirty += o.ad_dirty; ad_latency_sum += o.ad_latency_sum;
+    clean_write_hits += o.clean_write_hits;
+    nested_walks += o.nested_walks;
+    guest_walk_reads += o.guest_walk_reads;
+    host_walk_reads += o.host_walk_reads;
+    nested_tlb_hits += o.nested_tlb_hits;
+    nested_tlb_misses += o.nested_tlb_misses;
+    s2_pwc_hits += o.s2_pwc_hits; s2_pwc_misses += o.s2_pwc_misses;
+    s2_faults += o.s2_faults;
+    walk_latency += o.walk_latency;
+    queue_latency += o.queue_latency;
+    memory_latency += o.memory_latency;
+    for (int i = 0; i <= MAX_READS_PER_WALK; i++)
+      reads_per_walk[i] += o.reads_per_walk[i];
+    if (o.channel_reads.size() > channel_reads.size()) {
+      channel_reads.resize(o.channel_reads.size(), 0);
+      channel_latency_sum.resize(o.channel_reads.size(), 0);
+    }
+    for (size_t i = 0; i < o.channel_reads.size(); i++) {
+      channel_reads[i] += o.channel_reads[i];
+      channel_latency_sum[i] += o.channel_latency_sum[i];
+    }
+    return *this;
+  }
+
+  void print_stats(FILE* out) const {
+    fprintf(out, "walks: %lu (failed %lu, merged %lu, stalls %lu)\n", walks,
+            fails, walk_merges, submit_stalls);
+    fprintf(out, "walk leaf 4KB/2MB/1GB: %lu/%lu/%lu\n", leaf_4k, leaf_2m,
+            leaf_1g);
+    fprintf(out, "walk PTE reads: %lu (%.2f per walk)\n", walk_reads,
+            walks ? (double)walk_reads / walks : 0.0);
+    fprintf(out, "walk PTE reads per completed walk:\n");
+    for (int i = 0; i <= MAX_READS_PER_WALK; i++) {
+      if (!reads_per_walk[i]) continue;
+      fprintf(out, "\t%d%s: %lu\n", i, i == MAX_READS_PER_WALK ? "+" : "",
+              reads_per_walk[i]);
+    }
+    print_pwc(out, "PML4E", pml4e_pwc_hits, pml4e_pwc_misses);
+    print_pwc(out, "PDPTE", pdpte_pwc_hits, pdpte_pwc_misses);
+    print_pwc(out, "PDE", pde_pwc_hits, pde_pwc_misses);
+    if (nested_walks) {
+      fprintf(out, "nested walks: %lu, guest PTE reads %lu (%.2f per walk), "
+              "host PTE reads %lu (%.2f per walk), stage-2 faults %lu\n",
+              nested_walks, guest_walk_reads,
+              (double)guest_walk_reads / nested_walks, host_walk_reads,
+              (double)host_walk_reads / nested_walks, s2_faults);
+      if (nested_tlb_hits + nested_tlb_misses)
+        fprintf(out, "nested TLB hits %lu misses %lu hit_rate %.4f\n",
+                nested_tlb_hits, nested_tlb_misses,
+                (double)nested_tlb_hits /
+                    (nested_tlb_hits + nested_tlb_misses));
+      print_pwc(out, "Stage-2", s2_pwc_hits, s2_pwc_misses);
+    }
+    fprintf(out, "walker occupancy: %.2f avg busy, %.2f avg pending (max %lu)\n",
+            cycles ? (double)busy_walker_cycles / cycles : 0.0,
+            cycles ? (double)pending_walk_cycles / cycles : 0.0,
+            max_pending_walks);
+    walk_latency.print_stats(out, "walk latency");
+    queue_latency.print_stats(out, "walk queue latency");
+    memory_latency.print_stats(out, "walk memory latency");
+    print_channels(out);
+    if (page_faults)
+      fprintf(out, "page faults: %lu (avg latency %.2f)\n", page_faults,
+              fault_replays ? (double)fault_latency_sum / fault_replays : 0.0);
+    if (atc_hits + atc_misses + ats_requests)
+      fprintf(out, "ATC hits %lu misses %lu, ATS requests %lu (avg latency %.2f)\n",
+              atc_hits, atc_misses, ats_requests,
+              ats_requests ? (double)ats_latency_sum / ats_requests : 0.0);
+    if (prefetch_issued)
+      fprintf(out, "TLB prefetch: issued %lu useful %lu late %lu throttled %lu "
+              "unused %lu\n", prefetch_issued, prefetch_useful, prefetch_late,
+              prefetch_throttled, prefetch_unused_evictions);
+    if (ad_updates + clean_write_hits)
+      fprintf(out, "PTE A/D updates: %lu (A %lu, D %lu, avg latency %.2f), "
+              "clean write hits %lu\n", ad_updates, ad_accessed, ad_dirty,
+              ad_updates ? (double)ad_latency_sum / ad_updates : 0.0,
+              clean_write_hits);
+  }
+
+ private:
+  void print_channels(FILE* out) const {
+    uint64_t total = 0, max_reads = 0;
+    for (uint64_t reads : channel_reads) {
+      total += reads;
+      max_reads = std::max(max_reads, reads);
+    }
+    if (!total) return;
+    // max/avg가 1에 가까울수록 walk 트래픽이 채널에 고르게 퍼짐
+    fprintf(out, "walk PTE reads per channel (max/avg %.2f):\n",
+            (double)max_reads * channel_reads.size() / total);
+    for (size_t i = 0; i < channel_reads.size(); i++) {
+      if (!channel_reads[i]) continue;
+      fprintf(out, "\tch%zu: %lu (avg latency %.2f)\n", i, channel_reads[i],
+              (double)channel_latency_sum[i] / channel_reads[i]);
+    }
+  }
+  static void print_pwc(FILE* out, const char* name, uint64_t hit,
+                        uint64_t miss) {
+    if (hit + miss == 0) return;
+    fprintf(out, "%s PWC hits %lu misses %lu hit_rate %.4f\n", name, hit, miss,
+            (double)hit / (hit + miss));
+  }
+};
+
+// 구간/커널별 변환 로그용 누적 카운터. 두 시점의 차이로 구간 값을 구한다
+struct TranslationCounters {
+  uint64_t itlb_hits = 0, itlb_misses = 0;
+  uint64_t dtlb_hits = 0, dtlb_misses = 0;
+  uint64_t stlb_hits = 0, stlb_misses = 0;
+  uint64_t walks = 0, walk_reads = 0;
+  uint64_t ad_updates = 0;    // PTE A/D RMW
+  uint64_t demand_walks = 0;  // 지연을 잰 demand walk 수
+  uint64_t walk_latency_sum = 0, queue_latency_sum = 0, memory_latency_sum = 0;
+  uint64_t mem_requests = 0;  // unit이 메모리 쪽으로 보낸 data 요청
+
+  TranslationCounters& operator+=(const TranslationCounters& o) {
+    itlb_hits += o.itlb_hits; itlb_misses += o.itlb_misses;
+    dtlb_hits += o.dtlb_hits; dtlb_misses += o.dtlb_misses;
+    stlb_hits += o.stlb_hits; stlb_misses += o.stlb_misses;
+    walks += o.walks; walk_reads += o.walk_reads;
+    ad_updates += o.ad_updates;
+    demand_walks += o.demand_walks;
+    walk_latency_sum += o.walk_latency_sum;
+    queue_latency_sum += o.queue_latency_sum;
+    memory_latency_sum += o.memory_latency_sum;
+    mem_requests += o.mem_requests;
+    return *this;
+  }
+  TranslationCounters operator-(const TranslationCounters& o) const {
+    TranslationCounters d;
+    d.itlb_hits = itlb_hits - o.itlb_hits;
+    d.itlb_misses = itlb_misses - o.itlb_misses;
+    d.dtlb_hits = dtlb_hits - o.dtlb_hits;
+    d.dtlb_misses = dtlb_misses - o.dtlb_misses;
+    d.stlb_hits = stlb_hits - o.stlb_hits;
+    d.stlb_misses = stlb_misses - o.stlb_misses;
+    d.walks = walks - o.walks;
+    d.walk_reads = walk_reads - o.walk_reads;
+    d.ad_updates = ad_updates - o.ad_updates;
+    d.demand_walks = demand_walks - o.demand_walks;
+    d.walk_latency_sum = walk_latency_sum - o.walk_latency_sum;
+    d.queue_latency_sum = queue_latency_sum - o.queue_latency_sum;
+    d.memory_latency_sum = memory_latency_sum - o.memory_latency_sum;
+    d.mem_requests = mem_requests - o.mem_requests;
+    return d;
+  }
+
+  static double ratio(uint64_t a, uint64_t b) { return b ? (double)a / b : 0.0; }
+  double itlb_hit_rate() const { return ratio(itlb_hits, itlb_hits + itlb_misses); }
+  double dtlb_hit_rate() const { return ratio(dtlb_hits, dtlb_hits + dtlb_misses); }
+  double stlb_hit_rate() const { return ratio(stlb_hits, stlb_hits + stlb_misses); }
+  double reads_per_walk() const { return ratio(walk_reads, walks); }
+  double avg_walk_latency() const { return ratio(walk_latency_sum, demand_walks); }
+  double avg_queue_latency() const { return ratio(queue_latency_sum, demand_walks); }
+  double avg_memory_latency() const { return ratio(memory_latency_sum, demand_walks); }
+  // PTE read/A·D RMW가 unit의 메모리 요청(data + PTE)에서 차지하는 비율
+  uint64_t walk_traffic() const { return walk_reads + ad_updates; }
+  double walk_traffic_share() const {
+    return ratio(walk_traffic(), walk_traffic() + mem_requests);
+  }
+};
+
+}  // namespace NDPSim
+#endif
+#endif  // TIMING_SIMULATION
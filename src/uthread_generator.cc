@@ -2,6 +2,7 @@
 #include "uthread_generator.h"
 
 #include "memory_map.h"
+#include "tlb.h"
 namespace NDPSim {
 
 static unsigned long long global_req_id = 0;
@@ -44,6 +45,11 @@ void UThreadGenerator::print_status() {
                     m_ndp_id, info.launch_id, info.kernel_name, info.base_addr,
                     info.size, count, total);
   }
+  if (m_config->is_uthread_tlb_aware())
+    spdlog::debug("NDP {} TLB-aware uthreads: resident {} pending-walk {} "
+                  "reordered {} throttled {}",
+                  m_ndp_id, m_tlb_resident_picks, m_tlb_pending_picks,
+                  m_tlb_reorders, m_tlb_throttled);
 }
 
 void UThreadGenerator::launch(KernelLaunchInfo kinfo) {
@@ -101,6 +107,7 @@ void UThreadGenerator::launch(KernelLaunchInfo kinfo) {
       RequestInfo* info = new RequestInfo();
       info->kernel_id = kernel_id;
       info->launch_id = launch_id;
+      info->asid = kinfo.asid;
       info->id = global_req_id++;
       info->addr = base;
       info->offset = m_ndp_id;
@@ -113,6 +120,7 @@ void UThreadGenerator::launch(KernelLaunchInfo kinfo) {
     info->kernel_id = kernel_id;
     info->id = global_req_id++;
     info->launch_id = launch_id;
+    info->asid = kinfo.asid;
     info->addr = addr;
     info->offset = addr - base;
     info->type = KERNEL_BODY;
@@ -127,6 +135,7 @@ void UThreadGenerator::launch(KernelLaunchInfo kinfo) {
       info->kernel_id = kernel_id;
       info->id = global_req_id++;
       info->launch_id = launch_id;
+      info->asid = kinfo.asid;
       info->addr = addr;
       info->offset = addr - base;
       info->type = KERNEL_BODY;
@@ -140,6 +149,7 @@ void UThreadGenerator::launch(KernelLaunchInfo kinfo) {
     info->kernel_id = kernel_id;
     info->id = global_req_id++;
     info->launch_id = launch_id;
+    info->asid = kinfo.asid;
     info->addr = base;
     info->offset = m_ndp_id;
     info->type = FINALIZER;
@@ -210,12 +220,15 @@ bool UThreadGenerator::generate_uthreads(int threads) {
         m_generated_requests.erase(launch_id);
         return false;
       }
-      RequestInfo* info = m_generated_requests[launch_id].front();
+      std::deque<RequestInfo*>& requests = m_generated_requests[launch_id];
+      RequestInfo* info = requests.front();
       if (info->type == KERNEL_BODY) {
         //have to check INITIALIZER request is done at sub-core
         if (m_count_requests[launch_id] >= 1) {
-          m_uthread_request_queue->push(info);
-          m_generated_requests[launch_id].pop_front();
+          int pos = pick_kernel_body(requests);
+          if (pos < 0) return can_issue;
+          m_uthread_request_queue->push(requests[pos]);
+          requests.erase(requests.begin() + pos);
           can_issue = true;
         }
       }
@@ -224,6 +237,39 @@ bool UThreadGenerator::generate_uthreads(int threads) {
   return can_issue;
 }
 
+int UThreadGenerator::pick_kernel_body(std::deque<RequestInfo*>& requests) {
+  if (!m_config->is_uthread_tlb_aware() || !m_dtlb) return 0;
+  // 같은 kernel body 안에서만 순서를 바꿈 (body 간 순서는 check_can_issue)
+  RequestInfo* front = requests.front();
+  int window = std::min<int>(m_config->get_uthread_tlb_window(), requests.size());
+  int pending = -1;
+  for (int i = 0; i < window; i++) {
+    RequestInfo* info = requests[i];
+    if (info->type != KERNEL_BODY ||
+        info->kernel_body_id != front->kernel_body_id)
+      break;
+    if (m_dtlb->is_resident(info->asid, info->addr)) {
+      m_tlb_resident_picks++;
+      if (i > 0) m_tlb_reorders++;
+      return i;
+    }
+    // 이미 walk 중인 페이지는 새 walk 없이 MSHR에 합쳐짐
+    if (pending < 0 && m_dtlb->is_walk_pending(info->asid, info->addr))
+      pending = i;
+  }
+  if (pending >= 0) {
+    m_tlb_pending_picks++;
+    if (pending > 0) m_tlb_reorders++;
+    return pending;
+  }
+  // 남은 후보는 모두 새 walk를 일으킴: walker가 포화면 잠시 보류
+  if (m_dtlb->is_walker_saturated()) {
+    m_tlb_throttled++;
+    return -1;
+  }
+  return 0;
+}
+
 void UThreadGenerator::check_kernel_launch() {
   if (!m_launch_queue.empty() && !m_launched) {
     int launch_id = m_launch_queue.front();
@@ -11,6 +11,8 @@
 #include "common_defs.h"
 
 namespace NDPSim {
+class Tlb;
+
 class UThreadGenerator {
  public:
   UThreadGenerator(M2NDPConfig* config, int ndp_id,
@@ -30,6 +32,8 @@ class UThreadGenerator {
   void increase_count(int launch_id);
   uint32_t get_allocated_spad_size();
   bool generate_uthreads(int threads);
+  // translation-aware 스케줄링에서 상태를 볼 DTLB
+  void set_tlb(Tlb* dtlb) { m_dtlb = dtlb; }
  private:
   M2NDPConfig* m_config;
   int m_ndp_id;
@@ -47,6 +51,16 @@ class UThreadGenerator {
   std::map<int, int> m_total_requests;
   std::map<int, int> m_count_requests;
 
+  // translation-aware 스케줄링 (uthread_tlb_aware)
+  Tlb* m_dtlb = nullptr;
+  uint64_t m_tlb_resident_picks = 0;  // TLB에 있는 페이지의 uthread를 고른 수
+  uint64_t m_tlb_pending_picks = 0;   // 진행 중인 walk에 합쳐질 uthread를 고른 수
+  uint64_t m_tlb_reorders = 0;        // 맨 앞이 아닌 uthread를 먼저 낸 수
+  uint64_t m_tlb_throttled = 0;       // walker 포화로 발행을 미룬 수
+
+  // 다음에 낼 KERNEL_BODY의 큐 내 위치 (-1이면 이번 cycle은 보류)
+  int pick_kernel_body(std::deque<RequestInfo*>& requests);
+
   bool check_addr_match(uint64_t addr);
   int get_next_launch_id();
   bool check_can_issue(RequestInfo* info);
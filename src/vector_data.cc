@@ -2,6 +2,8 @@
 
 #include <fp16.h>
 
+#include <cassert>
+#include <cstring>
 #include <iostream>
 
 #include "common.h"
@@ -177,6 +179,19 @@ uint8_t VectorData::GetVmaskAsByte(int index) const {
 
 uint32_t VectorData::GetVlen() const { return m_vlen; }
 
+void VectorData::CopyLine(void *dst) const {
+  assert(m_data.size() >= PACKET_ENTRIES);
+  memcpy(dst, m_data.data(), PACKET_SIZE);
+}
+
+void VectorData::LoadLine(const void *src, DataType type, uint32_t vlen) {
+  m_data.resize(PACKET_ENTRIES);
+  memcpy(m_data.data(), src, PACKET_SIZE);
+  m_type = type;
+  m_vlen = vlen;
+  m_double_reg = false;
+}
+
 uint32_t VectorData::GetPrecision() const {
   switch (m_type) {
     case INT64:
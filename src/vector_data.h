@@ -108,6 +108,9 @@ class VectorData {
   uint32_t GetVlen() const;
   uint32_t GetPrecision() const;
   size_t GetVectorSize() { return m_data.size(); }
+  // PACKET_SIZE 라인 하나를 raw 바이트로 (FlatMemoryMap 저장용)
+  void CopyLine(void *dst) const;
+  void LoadLine(const void *src, DataType type, uint32_t vlen);
   void Append(VectorData &rhs);
   std::array<VectorData, 2> Split();
   VectorData Max(VectorData &rhs);
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "memory_map.h"
+
+namespace NDPSim {
+// dtype 하나짜리 텍스트 memory map (라인 num_lines개)
+static std::string write_memory_map(const std::string& dtype, int num_entries,
+                                    int num_lines) {
+  std::string path = testing::TempDir() + "memory_map_test_" + dtype + ".data";
+  std::ofstream ofs(path);
+  ofs << "_META_\n" << dtype << "\n_DATA_\n";
+  for (int line = 0; line < num_lines; line++) {
+    // 4KB 페이지 경계를 넘도록 간격을 둠
+    ofs << "0x" << std::hex << 0x10000000 + line * 3 * PACKET_SIZE << std::dec;
+    for (int i = 0; i < num_entries; i++) {
+      int value = line * num_entries + i;
+      if (dtype == "float16" || dtype == "float32")
+        ofs << " " << value * 0.5f;
+      else if (dtype == "int32" || dtype == "int64")
+        ofs << " " << value - 100;
+      else if (dtype == "char8")
+        ofs << " " << value % 256 - 128;
+      else if (dtype == "bool8")
+        ofs << " " << value % 2;
+      else
+        ofs << " " << value % 256;
+    }
+    ofs << "\n";
+  }
+  return path;
+}
+
+static void expect_same_lines(HashMemoryMap& hash, FlatMemoryMap& flat) {
+  std::vector<uint64_t> hash_addrs = hash.GetAddrs();
+  std::vector<uint64_t> flat_addrs = flat.GetAddrs();
+  std::sort(hash_addrs.begin(), hash_addrs.end());
+  std::sort(flat_addrs.begin(), flat_addrs.end());
+  ASSERT_EQ(hash_addrs, flat_addrs);
+  for (uint64_t addr : hash_addrs) {
+    VectorData hash_data = hash.Load(addr);
+    VectorData flat_data = flat.Load(addr);
+    ASSERT_EQ(hash_data.GetType(), flat_data.GetType());
+    uint8_t hash_line[PACKET_SIZE], flat_line[PACKET_SIZE];
+    hash_data.CopyLine(hash_line);
+    flat_data.CopyLine(flat_line);
+    ASSERT_EQ(0, memcmp(hash_line, flat_line, PACKET_SIZE)) << std::hex << addr;
+  }
+  EXPECT_TRUE(hash.Match(flat));
+  EXPECT_TRUE(flat.Match(hash));
+}
+
+TEST(MemoryMapHashFlatParityTest, EveryDataType) {
+  const std::vector<std::pair<std::string, int>> dtypes = {
+      {"float16", PACKET_SIZE / 2}, {"float32", PACKET_SIZE / 4},
+      {"int16", PACKET_SIZE / 2},   {"int32", PACKET_SIZE / 4},
+      {"int64", PACKET_SIZE / 8},   {"char8", PACKET_SIZE},
+      {"uint8", PACKET_SIZE},       {"bool8", PACKET_SIZE}};
+  for (auto& [dtype, num_entries] : dtypes) {
+    SCOPED_TRACE(dtype);
+    std::string path = write_memory_map(dtype, num_entries, 300);
+    HashMemoryMap hash(path);
+    FlatMemoryMap flat(path, 4096);
+    EXPECT_EQ(hash.GetAddrs().size(), 300);
+    EXPECT_EQ(flat.GetNumLines(), 300);
+    expect_same_lines(hash, flat);
+    std::remove(path.c_str());
+  }
+}
+
+TEST(MemoryMapHashFlatParityTest, StoreAfterLoad) {
+  std::string path = write_memory_map("int32", PACKET_SIZE / 4, 10);
+  HashMemoryMap hash(path);
+  FlatMemoryMap flat(path, 4096);
+  VectorData data = hash.Load(0x10000000);
+  data.SetData((int32_t)12345, 0);
+  hash.Store(0x10000000, data);
+  EXPECT_FALSE(hash.Match(flat));
+  flat.Store(0x10000000, data);
+  expect_same_lines(hash, flat);
+  std::remove(path.c_str());
+}
+
+static VectorData int32_line(int32_t value) {
+  VectorData data(32, 1);
+  data.SetType(INT32);
+  for (int i = 0; i < PACKET_SIZE / 4; i++) data.SetData(value, i);
+  return data;
+}
+
+TEST(FlatMemoryMapSnapshotTest, CopyOnWriteAndRestore) {
+  const uint64_t x = 0x10000000, y = x + PACKET_SIZE, z = x + 4096;
+  FlatMemoryMap a(4096);
+  a.Store(x, int32_line(1));
+  a.Store(y, int32_line(2));
+  // 마지막 Store로 x/y 페이지가 a의 last-page 캐시(단독 소유)인 채로 snapshot
+  std::unique_ptr<MemoryMap> snapshot(a.Snapshot());
+  MemoryMap& s = *snapshot;
+
+  a.Store(x, int32_line(10));
+  EXPECT_EQ(a.Load(x).GetIntData(0), 10);
+  EXPECT_EQ(s.Load(x).GetIntData(0), 1);
+  a.Store(z, int32_line(11));
+  EXPECT_FALSE(s.CheckAddr(z));
+
+  s.Store(y, int32_line(20));
+  EXPECT_EQ(s.Load(y).GetIntData(0), 20);
+  EXPECT_EQ(a.Load(y).GetIntData(0), 2);
+
+  a.Restore(s);
+  EXPECT_EQ(a.Load(x).GetIntData(0), 1);
+  EXPECT_EQ(a.Load(y).GetIntData(0), 20);
+  EXPECT_FALSE(a.CheckAddr(z));
+  EXPECT_EQ(a.GetNumLines(), 2);
+  // restore 뒤에는 다시 페이지를 공유하므로 양쪽 Store가 서로 안 보여야 함
+  a.Store(x, int32_line(30));
+  s.Store(y, int32_line(40));
+  EXPECT_EQ(a.Load(x).GetIntData(0), 30);
+  EXPECT_EQ(a.Load(y).GetIntData(0), 20);
+  EXPECT_EQ(s.Load(x).GetIntData(0), 1);
+  EXPECT_EQ(s.Load(y).GetIntData(0), 40);
+}
+
+static std::vector<char> read_file(const std::string& path) {
+  std::ifstream ifs(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(ifs), {});
+}
+
+TEST(MemoryImageTest, RoundTripAndPrivateStore) {
+  std::string text_path = write_memory_map("float32", PACKET_SIZE / 4, 300);
+  std::string image_path = testing::TempDir() + "memory_map_test.mimg";
+  FlatMemoryMap(text_path, 4096).SaveImage(image_path);
+  std::vector<char> image_bytes = read_file(image_path);
+  ASSERT_FALSE(image_bytes.empty());
+
+  // backend와 상관없이 image는 FlatMemoryMap으로 매핑
+  std::unique_ptr<MemoryMap> mapped(MemoryMap::New("hash", image_path, 4096));
+  FlatMemoryMap* image = dynamic_cast<FlatMemoryMap*>(mapped.get());
+  ASSERT_NE(image, nullptr);
+  EXPECT_EQ(image->GetNumLines(), 300);
+  HashMemoryMap text(text_path);
+  expect_same_lines(text, *image);
+
+  // MAP_PRIVATE: Store는 map에만 보이고 파일은 그대로
+  image->Store(0x10000000, int32_line(12345));
+  EXPECT_EQ(image->Load(0x10000000).GetIntData(0), 12345);
+  EXPECT_FALSE(image->Match(text));
+  EXPECT_EQ(read_file(image_path), image_bytes);
+  std::remove(text_path.c_str());
+  std::remove(image_path.c_str());
+}
+}  // namespace NDPSim
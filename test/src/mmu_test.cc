@@ -0,0 +1,32 @@
+#ifdef TIMING_SIMULATION
+#include "gtest/gtest.h"
+#include "mmu.h"
+
+namespace NDPSim {
+// 페이지마다 miss가 여러 번 나는 (뒤의 miss는 MSHR merge) 순차 scan
+TEST(PrefetchStreamTest, SequentialScanWithSamePageMerges) {
+  PrefetchStream stream;
+  int prefetches = 0;
+  for (uint64_t vpn = 100; vpn < 110; vpn++)
+    for (int miss = 0; miss < 4; miss++) prefetches += stream.train(1, vpn);
+  // 세 번째 페이지부터 페이지마다 한 번 (같은 페이지 merge에서는 안 냄)
+  EXPECT_EQ(prefetches, 8);
+  EXPECT_EQ(stream.stride, 1);
+  EXPECT_EQ(stream.confidence, 3);
+}
+
+TEST(PrefetchStreamTest, StrideChangeAndAsidSwitchReset) {
+  PrefetchStream stream;
+  EXPECT_FALSE(stream.train(1, 10));
+  EXPECT_FALSE(stream.train(1, 12));
+  EXPECT_TRUE(stream.train(1, 14));
+  EXPECT_FALSE(stream.train(1, 14));  // merge는 학습하지 않음
+  EXPECT_EQ(stream.confidence, 1);
+  EXPECT_FALSE(stream.train(1, 15));  // stride 바뀜
+  EXPECT_EQ(stream.confidence, 0);
+  EXPECT_FALSE(stream.train(2, 16));  // 다른 address space
+  EXPECT_FALSE(stream.train(2, 17));
+  EXPECT_TRUE(stream.train(2, 18));
+}
+}  // namespace NDPSim
+#endif